@@ -0,0 +1,88 @@
+//
+// Time of the distributed gram and of its result assembly as a function of
+// I_n. The assembly is timed both with one allgatherv per column, as gram did
+// before, and with the packed allgather_rows_ it uses now.
+//
+// Usage: mpirun -n <p> diana-benchmark-gram [max_log2_I] [cols] [repeat]
+//
+
+#include "tensor.hpp"
+#include "logger.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+namespace {
+    double best_time_(const std::function<void()> &kernel, int repeat) {
+        double best = INFINITY;
+        for (int i = 0; i < repeat; i++) {
+            Communicator<double>::barrier();
+            double begin = MPI_Wtime();
+            kernel();
+            double time = MPI_Wtime() - begin;
+            Communicator<double>::allreduce_inplace(&time, 1, MPI_MAX);
+            best = std::min(best, time);
+        }
+        return best;
+    }
+} // namespace
+
+int main(int argc, char *argv[]) {
+    mpi_init(argc, argv);
+    const int kMaxLog2I = argc > 1 ? std::stoi(argv[1]) : 13;
+    const size_t kCols = argc > 2 ? std::stoul(argv[2]) : 256;
+    const int kRepeat = argc > 3 ? std::stoi(argv[3]) : 5;
+    const auto kP = (size_t) mpi_size();
+    const auto kRank = (size_t) mpi_rank();
+    if (kRank == 0) {
+        printf("%-8s %-6s %14s %18s %18s\n", "I_n", "procs", "gram(s)",
+               "per-column(s)", "packed(s)");
+    }
+    auto *distribution = new DistributionCartesianBlock({kP, 1}, mpi_rank());
+    for (int log2_I = 8; log2_I <= kMaxLog2I; log2_I++) {
+        const size_t kI = (size_t) 1 << log2_I;
+        Tensor<double> A(distribution, {kI, kCols});
+        A.randn();
+        double time_gram = best_time_([&]() {
+            Function::gram<double>(A, 0);
+        }, kRepeat);
+        // Row blocks of the gram result, as left by the ring.
+        size_t *rows = Operator<size_t>::alloc(kP);
+        size_t *recvcounts = Operator<size_t>::alloc(kP);
+        size_t *displs = Operator<size_t>::alloc(kP);
+        for (size_t p = 0; p < kP; p++) {
+            rows[p] = DIANA_CEILDIV(kI * (p + 1), kP) -
+                      DIANA_CEILDIV(kI * p, kP);
+            recvcounts[p] = rows[p];
+            displs[p] = DIANA_CEILDIV(kI * p, kP);
+        }
+        double *buf = Operator<double>::alloc(rows[kRank] * kI);
+        double *C = Operator<double>::alloc(kI * kI);
+        Operator<double>::constant(buf, 1.0, rows[kRank] * kI);
+        double time_per_column = best_time_([&]() {
+            for (size_t j = 0; j < kI; j++) {
+                Communicator<double>::allgatherv(buf + j * rows[kRank],
+                                                 rows[kRank],
+                                                 C + j * kI, recvcounts,
+                                                 displs);
+            }
+        }, kRepeat);
+        double time_packed = best_time_([&]() {
+            Function::allgather_rows_(C, buf, rows, kP, kRank, kI,
+                                      MPI_COMM_WORLD);
+        }, kRepeat);
+        if (kRank == 0) {
+            printf("%-8zu %-6zu %14.6f %18.6f %18.6f\n", kI, kP, time_gram,
+                   time_per_column, time_packed);
+        }
+        Operator<double>::free(buf);
+        Operator<double>::free(C);
+        Operator<size_t>::free(rows);
+        Operator<size_t>::free(recvcounts);
+        Operator<size_t>::free(displs);
+    }
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,89 @@
+//
+// Bandwidth of the elementwise kernels add / sub / mul / nmul / constant /
+// fnorm for every supported dtype. The GB/s printed here are measured around
+// the call; the Bandw.(GB/s) column of the summary printed at the end is what
+// the kernels record themselves, averaged over all dtypes, sizes and repeats.
+//
+// Usage: diana-benchmark-elementwise [max_log2_size] [repeat]
+//
+
+#include "operator.hpp"
+#include "communicator.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+namespace {
+    double best_time_(const std::function<void()> &kernel, int repeat) {
+        double best = INFINITY;
+        for (int i = 0; i < repeat; i++) {
+            auto begin = std::chrono::steady_clock::now();
+            kernel();
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best,
+                            std::chrono::duration<double>(end - begin).count());
+        }
+        return best;
+    }
+
+    void print_row_(const std::string &dtype, const std::string &kernel,
+                    size_t n, size_t bytes, double time) {
+        printf("%-10s %-10s %12zu %12.6f %12.3f\n", dtype.c_str(),
+               kernel.c_str(), n, time, (double) bytes / 1073741824 / time);
+    }
+
+    template<typename Ty>
+    void benchmark_(const std::string &dtype, size_t n, int repeat) {
+        Ty *A = Operator<Ty>::alloc(n);
+        Ty *B = Operator<Ty>::alloc(n);
+        Ty *C = Operator<Ty>::alloc(n);
+        Operator<Ty>::constant(A, Ty(1), n);
+        Operator<Ty>::constant(B, Ty(2), n);
+        Operator<Ty>::constant(C, Ty(0), n);
+        const size_t kBytes = n * sizeof(Ty);
+        print_row_(dtype, "add", n, 3 * kBytes, best_time_([&]() {
+            Operator<Ty>::add(C, A, B, n);
+        }, repeat));
+        print_row_(dtype, "sub", n, 3 * kBytes, best_time_([&]() {
+            Operator<Ty>::sub(C, A, B, n);
+        }, repeat));
+        print_row_(dtype, "mul", n, 3 * kBytes, best_time_([&]() {
+            Operator<Ty>::mul(C, A, B, n);
+        }, repeat));
+        print_row_(dtype, "nmul", n, 2 * kBytes, best_time_([&]() {
+            Operator<Ty>::nmul(C, A, Ty(3), n);
+        }, repeat));
+        print_row_(dtype, "constant", n, kBytes, best_time_([&]() {
+            Operator<Ty>::constant(C, Ty(4), n);
+        }, repeat));
+        print_row_(dtype, "fnorm", n, kBytes, best_time_([&]() {
+            Operator<Ty>::fnorm(A, n);
+        }, repeat));
+        Operator<Ty>::free(A);
+        Operator<Ty>::free(B);
+        Operator<Ty>::free(C);
+    }
+} // namespace
+
+int main(int argc, char *argv[]) {
+    mpi_init(argc, argv);
+    const int kMaxLog2Size = argc > 1 ? std::stoi(argv[1]) : 24;
+    const int kRepeat = argc > 2 ? std::stoi(argv[2]) : 5;
+    printf("%-10s %-10s %12s %12s %12s\n", "dtype", "kernel", "n", "time(s)",
+           "GB/s");
+    Summary::init();
+    for (int log2_size = 16; log2_size <= kMaxLog2Size; log2_size += 4) {
+        const size_t kN = (size_t) 1 << log2_size;
+        benchmark_<float>("float", kN, kRepeat);
+        benchmark_<double>("double", kN, kRepeat);
+        benchmark_<complex32>("complex32", kN, kRepeat);
+        benchmark_<complex64>("complex64", kN, kRepeat);
+    }
+    Summary::finalize();
+    Summary::print_summary();
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,87 @@
+//
+// Bandwidth of the tenmat / tenmatt / mattten kernels against STREAM copy.
+//
+// Usage: diana-benchmark-tenmat [max_log2_size] [repeat]
+//
+
+#include "operator.hpp"
+#include "util.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+namespace {
+    double best_time_(const std::function<void()> &kernel, int repeat) {
+        double best = INFINITY;
+        for (int i = 0; i < repeat; i++) {
+            auto begin = std::chrono::steady_clock::now();
+            kernel();
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best,
+                            std::chrono::duration<double>(end - begin).count());
+        }
+        return best;
+    }
+
+    shape_t cube_shape_(size_t size, size_t ndim) {
+        auto dim = (size_t) std::round(std::pow((double) size, 1.0 / (double) ndim));
+        return shape_t(ndim, dim);
+    }
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const int kMaxLog2Size = argc > 1 ? std::stoi(argv[1]) : 24;
+    const int kRepeat = argc > 2 ? std::stoi(argv[2]) : 5;
+    printf("%-24s %-5s %-10s %12s %12s %10s\n", "shape", "mode", "kernel",
+           "time(s)", "GB/s", "% STREAM");
+    for (int log2_size = 20; log2_size <= kMaxLog2Size; log2_size += 2) {
+        for (size_t ndim = 2; ndim <= 5; ndim++) {
+            shape_t shape = cube_shape_((size_t) 1 << log2_size, ndim);
+            const size_t kSize = Util::calc_size(shape);
+            const double kBytes = 2.0 * (double) kSize * sizeof(double);
+            double *A = Operator<double>::alloc(kSize);
+            double *B = Operator<double>::alloc(kSize);
+            Operator<double>::constant(A, 1.0, kSize);
+            Operator<double>::constant(B, 0.0, kSize);
+            // STREAM copy reference.
+            double stream = kBytes / best_time_([&]() {
+#ifdef DIANA_OPENMP
+#pragma omp parallel for default(none) shared(A, B, kSize)
+#endif
+                for (size_t i = 0; i < kSize; i++) {
+                    B[i] = A[i];
+                }
+            }, kRepeat) / 1e9;
+            std::string shape_str;
+            for (auto d: shape) {
+                shape_str += (shape_str.empty() ? "" : "x") + std::to_string(d);
+            }
+            printf("%-24s %-5s %-10s %12s %12.3f %10.1f\n", shape_str.c_str(),
+                   "-", "copy", "-", stream, 100.0);
+            for (size_t n = 0; n < ndim; n++) {
+                const std::pair<const char *,
+                        void (*)(double *, double *, const shape_t &,
+                                 size_t)> kKernels[] = {
+                        {"tenmat",  Operator<double>::tenmat},
+                        {"tenmatt", Operator<double>::tenmatt},
+                        {"mattten", Operator<double>::mattten},
+                };
+                for (const auto &kernel: kKernels) {
+                    double time = best_time_([&]() {
+                        kernel.second(B, A, shape, n);
+                    }, kRepeat);
+                    double bandwidth = kBytes / time / 1e9;
+                    printf("%-24s %-5zu %-10s %12.6f %12.3f %10.1f\n",
+                           shape_str.c_str(), n, kernel.first, time, bandwidth,
+                           100.0 * bandwidth / stream);
+                }
+            }
+            Operator<double>::free(A);
+            Operator<double>::free(B);
+        }
+    }
+    return 0;
+}
@@ -7,12 +7,62 @@
 
 namespace Algorithm {
     namespace Tucker {
+        /**
+         * @brief How HOOI_ALS forms the TTM chains of a sweep.
+         */
+        enum class TTMcSchedule {
+            kFlat, /**< One chain per mode, O(N^2) TTMs per sweep. */
+            kTree  /**< Binary dimension tree, O(N log N) TTMs per sweep. */
+        };
+
+        /**
+         * @brief Statistics of one sweep of an iterative Tucker algorithm.
+         */
+        struct Iteration {
+            double core_norm;  /**< \f$ \|\bm{\mathcal{G}}\|_F \f$ */
+            double residual;   /**< Relative residual of the approximation. */
+            double time;       /**< Wall time in seconds. */
+            size_t comm_bytes; /**< Bytes sent by this process. */
+        };
+
+        /**
+         * @brief Core tensor, factors and history of a Tucker decomposition.
+         */
+        template<typename Ty>
+        struct Result {
+            Tensor<Ty> G;
+            std::vector<Tensor<Ty>> U;
+            std::vector<Iteration> iterations;
+            bool converged;
+        };
+
+        /**
+         * @brief Initial factors of HOOI_ALS.
+         */
+        enum class Initializer {
+            kRandom, /**< Orthonormalized Gaussian matrices. */
+            kSTHOSVD /**< Factors of STHOSVD. */
+        };
+
+        template<typename Ty>
+        Result<Ty> STHOSVD(const Tensor<Ty> &A, const shape_t &R);
+
+        template<typename Ty>
+        Result<Ty> Randomized_STHOSVD(const Tensor<Ty> &A, const shape_t &R,
+                                      size_t oversampling = 10,
+                                      size_t power_iter = 1);
+
         template<typename Ty>
-        std::tuple<Tensor<Ty>, std::vector<Tensor<Ty>>>
-        HOOI_ALS(const Tensor<Ty> &A, const shape_t &R, size_t max_iter);
+        Result<Ty>
+        HOOI_ALS(const Tensor<Ty> &A, const shape_t &R, size_t max_iter,
+                 double tol = 0, Initializer init = Initializer::kSTHOSVD,
+                 TTMcSchedule schedule = TTMcSchedule::kTree,
+                 size_t memory_budget = SIZE_MAX);
     }; // namespace GRQI
 }; // namespace Algorithm
 
+#include "algorithm/tucker/sthosvd.tpp"
+#include "algorithm/tucker/randomized_sthosvd.tpp"
 #include "algorithm/tucker/hooi_als.tpp"
 
 #endif
\ No newline at end of file
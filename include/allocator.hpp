@@ -0,0 +1,55 @@
+#ifndef __DIANA_CORE_INCLUDE_ALLOCATOR_HPP__
+#define __DIANA_CORE_INCLUDE_ALLOCATOR_HPP__
+
+#include "def.hpp"
+
+#include <atomic>
+
+/**
+ * @brief Size-class caching allocator used by Operator<Ty>::alloc/free.
+ *
+ * Every request is rounded up to a size class (four classes per power of
+ * two) and returned blocks are kept in a per-class free list, so the same
+ * buffer sizes requested again and again by the distributed kernels are
+ * served without touching the system allocator. The cache never holds more
+ * than the peak of bytes in use, see Allocator::free. All blocks are aligned
+ * to Constant::kAllocatorAlignment bytes, and blocks of at least
+ * Constant::kHugePageSize bytes are aligned to, and advised as, huge pages.
+ */
+class Allocator {
+public:
+    struct Statistics {
+        size_t hit;          /**< Requests served from the cache. */
+        size_t miss;         /**< Requests served by the system allocator. */
+        size_t bytes_in_use; /**< Bytes currently handed out. */
+        size_t bytes_peak;   /**< Peak of bytes_in_use. */
+        size_t bytes_cached; /**< Bytes kept in the free lists. */
+    };
+
+private:
+    static std::atomic<size_t> hit_;
+    static std::atomic<size_t> miss_;
+    static std::atomic<size_t> bytes_in_use_;
+    static std::atomic<size_t> bytes_peak_;
+    static std::atomic<size_t> bytes_cached_;
+    static std::atomic<size_t> cache_limit_;
+
+public:
+    Allocator() = delete;
+
+    static void *alloc(size_t bytes);
+
+    static void free(void *ptr);
+
+    static void release();
+
+    static void set_cache_limit(size_t bytes);
+
+    static size_t miss();
+
+    static Statistics statistics();
+
+    static void reset_statistics();
+};
+
+#endif
@@ -2,9 +2,13 @@
 #define __DIANA_CORE_INCLUDE_COMMUNICATOR_HPP__
 
 #include <cstdlib>
+#include <functional>
 #include <mpi.h>
+#include <string>
 #include <vector>
 
+#include "summary.hpp"
+
 void mpi_init();
 
 void mpi_init(int argc, char **argv);
@@ -13,6 +17,65 @@ int mpi_rank();
 
 int mpi_size();
 
+size_t mpi_bytes_sent();
+
+void mpi_add_bytes_sent(size_t bytes);
+
+size_t mpi_max_count();
+
+void mpi_set_max_count(size_t count);
+
+/**
+ * @brief Handle of a non-blocking or persistent communication, which may
+ * consist of several MPI requests when its counts exceed mpi_max_count().
+ *
+ * The operation is (re)posted by start(), and the time spent blocked in
+ * wait() is recorded in Summary under the name of the operation, together
+ * with its communication. Persistent
+ * handles can be started again once completed. A handle still in flight is
+ * waited for on destruction.
+ */
+class Request {
+private:
+    std::vector<MPI_Request> requests_;
+    size_t event_;
+    Summary::Traffic traffic_;
+    Summary::tick_t tick_start_;
+    std::function<void(std::vector<MPI_Request> &)> start_;
+    bool persistent_;
+    bool native_;
+    bool active_;
+
+    void release_();
+
+    void complete_();
+
+public:
+    Request();
+
+    Request(size_t event, const Summary::Traffic &traffic,
+            std::function<void(std::vector<MPI_Request> &)> start,
+            bool persistent, std::vector<MPI_Request> requests = {});
+
+    Request(const Request &) = delete;
+
+    Request &operator=(const Request &) = delete;
+
+    Request(Request &&other) noexcept;
+
+    Request &operator=(Request &&other) noexcept;
+
+    ~Request();
+
+    void start();
+
+    void wait();
+
+    bool test();
+
+    [[nodiscard]] bool active() const;
+};
+
 template<typename Ty>
 class Communicator {
 private:
@@ -24,6 +87,8 @@ public:
 
     ~Communicator();
 
+    static Communicator<Ty> *instance();
+
     [[nodiscard]] int rank() const;
 
     [[nodiscard]] int size() const;
@@ -37,49 +102,105 @@ public:
     static MPI_Comm
     comm_split(int color, int rank, MPI_Comm comm = MPI_COMM_WORLD);
 
+    static MPI_Comm
+    cart_create(int ndim, const int *dims, MPI_Comm comm = MPI_COMM_WORLD);
+
+    static MPI_Comm cart_sub(MPI_Comm comm, const int *remain_dims);
+
+    static void comm_free(MPI_Comm *comm);
+
     static void
-    bcast(Ty *A, int size, int proc, MPI_Comm comm = MPI_COMM_WORLD);
+    bcast(Ty *A, size_t size, int proc, MPI_Comm comm = MPI_COMM_WORLD);
 
-    static void allreduce_inplace(Ty *A, int size, MPI_Op op,
+    static void allreduce_inplace(Ty *A, size_t size, MPI_Op op,
                                   MPI_Comm comm = MPI_COMM_WORLD);
 
-    static void allreduce(Ty *sendbuf, Ty *recvbuf, int size, MPI_Op op,
+    static void allreduce(Ty *sendbuf, Ty *recvbuf, size_t size, MPI_Op op,
                           MPI_Comm comm = MPI_COMM_WORLD);
 
     static void
-    sendrecv(Ty *A, int size, int dest, MPI_Comm comm = MPI_COMM_WORLD);
+    sendrecv(Ty *A, size_t size, int dest, MPI_Comm comm = MPI_COMM_WORLD);
 
-    static void sendrecv(Ty *sendbuf, int sendcount, int dest, Ty *recvbuf,
-                         int recvcount, int source,
+    static void sendrecv(Ty *sendbuf, size_t sendcount, int dest, Ty *recvbuf,
+                         size_t recvcount, int source,
                          MPI_Comm comm = MPI_COMM_WORLD);
 
-    static void reduce_scatter(Ty *sendbuf, Ty *recvbuf, const int *recvcounts,
-                               MPI_Op op, MPI_Comm comm = MPI_COMM_WORLD);
+    static void
+    reduce_scatter(Ty *sendbuf, Ty *recvbuf, const size_t *recvcounts,
+                   MPI_Op op, MPI_Comm comm = MPI_COMM_WORLD);
 
-    static void allgather(const Ty *sendbuf, int sendcount, Ty *recvbuf,
+    static void allgather(const Ty *sendbuf, size_t sendcount, Ty *recvbuf,
                           MPI_Comm comm = MPI_COMM_WORLD);
 
-    static void allgatherv(const Ty *sendbuf, int sendcount, Ty *recvbuf,
-                           const int *recvcounts, const int *displs,
+    static void allgatherv(const Ty *sendbuf, size_t sendcount, Ty *recvbuf,
+                           const size_t *recvcounts, const size_t *displs,
                            MPI_Comm comm = MPI_COMM_WORLD);
 
     static void
-    gatherv(Ty *sendbuf, int sendcount, Ty *recvbuf, const int *recvcounts,
-            const int *displs, int root, MPI_Comm comm = MPI_COMM_WORLD);
+    gatherv(Ty *sendbuf, size_t sendcount, Ty *recvbuf,
+            const size_t *recvcounts, const size_t *displs, int root,
+            MPI_Comm comm = MPI_COMM_WORLD);
 
-    static void scatterv(Ty *sendbuf, const int *sendcounts, const int *displs,
-                         Ty *recvbuf, int recvcount, int root,
-                         MPI_Comm comm = MPI_COMM_WORLD);
+    static void
+    scatterv(Ty *sendbuf, const size_t *sendcounts, const size_t *displs,
+             Ty *recvbuf, size_t recvcount, int root,
+             MPI_Comm comm = MPI_COMM_WORLD);
+
+    static Request iallreduce(const Ty *sendbuf, Ty *recvbuf, size_t size,
+                              MPI_Op op, MPI_Comm comm = MPI_COMM_WORLD);
+
+    static Request
+    ireduce_scatter(const Ty *sendbuf, Ty *recvbuf, const size_t *recvcounts,
+                    MPI_Op op, MPI_Comm comm = MPI_COMM_WORLD);
+
+    static Request
+    iallgatherv(const Ty *sendbuf, size_t sendcount, Ty *recvbuf,
+                const size_t *recvcounts, const size_t *displs,
+                MPI_Comm comm = MPI_COMM_WORLD);
+
+    static Request send_init(const Ty *buf, size_t count, int dest,
+                             MPI_Comm comm = MPI_COMM_WORLD, int tag = 0);
+
+    static Request recv_init(Ty *buf, size_t count, int source,
+                             MPI_Comm comm = MPI_COMM_WORLD, int tag = 0);
+
+    static Request
+    allreduce_init(const Ty *sendbuf, Ty *recvbuf, size_t size, MPI_Op op,
+                   MPI_Comm comm = MPI_COMM_WORLD);
+
+    static Request
+    reduce_scatter_init(const Ty *sendbuf, Ty *recvbuf,
+                        const size_t *recvcounts, MPI_Op op,
+                        MPI_Comm comm = MPI_COMM_WORLD);
+
+    static Request
+    allgatherv_init(const Ty *sendbuf, size_t sendcount, Ty *recvbuf,
+                    const size_t *recvcounts, const size_t *displs,
+                    MPI_Comm comm = MPI_COMM_WORLD);
+
+    static MPI_Datatype block_type(const std::vector<size_t> &shape,
+                                   const std::vector<size_t> &block_shape,
+                                   const std::vector<size_t> &block_start);
+
+    static void free_type(MPI_Datatype *type);
+
+    static void alltoallw(const Ty *sendbuf, const int *sendcounts,
+                          const MPI_Datatype *sendtypes, Ty *recvbuf,
+                          const int *recvcounts,
+                          const MPI_Datatype *recvtypes,
+                          MPI_Comm comm = MPI_COMM_WORLD);
 
     static void barrier(MPI_Comm comm = MPI_COMM_WORLD);
 
     static void wait(MPI_Request *request);
 
-    static void isend(MPI_Request *request, Ty *buf, int count, int dest,
+    static bool test(MPI_Request *request);
+
+    static void isend(MPI_Request *request, Ty *buf, size_t count, int dest,
                       MPI_Comm comm = MPI_COMM_WORLD,
                       int tag = 0);
 
-    static void irecv(MPI_Request *request, Ty *buf, int count, int source,
+    static void irecv(MPI_Request *request, Ty *buf, size_t count, int source,
                       MPI_Comm comm = MPI_COMM_WORLD,
                       int tag = 0);
 };
@@ -1,6 +1,7 @@
 #ifndef __DIANA_CORE_SRC_INCLUDE_DEF_HPP__
 #define __DIANA_CORE_SRC_INCLUDE_DEF_HPP__
 
+#include <cstdint>
 #include <cstdlib>
 
 #include <vector>
@@ -22,6 +23,28 @@ namespace Constant {
 // tensor.hpp
 const int kMaxPrintLength = 6;
 const int kPrintPrecision = 4;
+// util.hpp
+const uint64_t kRandomSeed = 0x5DEECE66DULL;
+// summary.hpp
+const size_t kSummaryDepth = 64;
+const size_t kSummaryEvents = 256;
+const size_t kSummaryEdges = 1 << 10;
+const size_t kSummaryRingSize = 1 << 16;
+const double kSummaryCalibration = 0.005;
+const double kNetworkLatency = 2e-6;
+const double kNetworkBandwidth = 10.0 * (1 << 30);
+// allocator.hpp
+const size_t kAllocatorAlignment = 64;
+const size_t kHugePageSize = 2 * 1024 * 1024;
+// operator/operator_cpu.tpp
+const size_t kTransposeTile = 32;
+const size_t kTransposeRunLength = 16;
+const size_t kElementwiseParallelSize = 1 << 15;
+const size_t kReductionBlock = 1 << 12;
+const size_t kReductionLanes = 8;
+const size_t kRandomChunk = 1024;
+// function/tensor.tpp
+const size_t kTTMChunkSize = 1 << 20;
 }; // namespace Constant
 
 #define DIANA_CEILDIV(n, k) (((n) + (k)-1) / (k))
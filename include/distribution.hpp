@@ -2,6 +2,7 @@
 #define __DIANA_CORE_DISTRIBUTION_TENSOR_HPP__
 
 #include "def.hpp"
+#include <map>
 #include <mpi.h>
 
 /**
@@ -29,6 +30,8 @@ public:
 
     explicit Distribution(Distribution::Type type);
 
+    virtual ~Distribution() = default;
+
     [[nodiscard]] Distribution::Type type() const;
 
     virtual void
@@ -60,11 +63,20 @@ private:
     shape_t partition_;
     shape_t coordinate_;
     size_t ndim_;
+    MPI_Comm process_cart_comm_;
     std::vector<MPI_Comm> process_fiber_comm_;
+    std::map<shape_t, MPI_Comm> process_grid_comm_;
 
 public:
     DistributionCartesianBlock(shape_t partition, int rank);
 
+    DistributionCartesianBlock(const DistributionCartesianBlock &) = delete;
+
+    DistributionCartesianBlock &
+    operator=(const DistributionCartesianBlock &) = delete;
+
+    ~DistributionCartesianBlock() override;
+
     [[nodiscard]] shape_t partition() const;
 
     [[nodiscard]] shape_t coordinate() const;
@@ -77,6 +89,10 @@ public:
                         shape_t &local_start,
                         shape_t &local_end) override;
 
+    void get_local_data(int rank, const shape_t &global_shape,
+                        shape_t &local_shape, shape_t &local_start,
+                        shape_t &local_end);
+
     void
     get_local_shape(const shape_t &global_shape, shape_t &local_shape) override;
 
@@ -87,6 +103,10 @@ public:
     std::tuple<int, int> process_fiber(size_t n);
 
     MPI_Comm process_fiber_comm(size_t n);
+
+    MPI_Comm process_slice_comm(size_t n);
+
+    MPI_Comm process_grid_comm(const shape_t &modes);
 };
 
 #endif
\ No newline at end of file
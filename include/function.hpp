@@ -26,11 +26,16 @@ namespace Function {
     template<typename Ty>
     std::tuple<Tensor<Ty>, Tensor<Ty>> reduced_QR(const Tensor<Ty> &A);
 
+    template<typename Ty>
+    std::tuple<Tensor<Ty>, Tensor<Ty>> eig_sym(const Tensor<Ty> &A);
+
     template<typename Ty>
     Tensor<Ty> gram(const Tensor<Ty> &A);
 
     // Tensor functions
 
+    inline void set_ttm_chunk_size(size_t size);
+
     template<typename Ty>
     Tensor<Ty> ttm(const Tensor<Ty> &A, const Tensor<Ty> &M, size_t n);
 
@@ -39,6 +44,10 @@ namespace Function {
     ttmc(const Tensor<Ty> &A, const std::vector<Tensor<Ty>> &M,
          const std::vector<size_t> &idx);
 
+    template<typename Ty>
+    Tensor<Ty>
+    ttmc(const Tensor<Ty> &A, const std::vector<Tensor<Ty>> &M, size_t skip);
+
     template<typename Ty>
     Tensor<Ty> gram(const Tensor<Ty> &A, size_t n);
 
@@ -46,10 +55,15 @@ namespace Function {
     template<typename Ty>
     Tensor<Ty> gather(const Tensor<Ty> &A);
 
+    template<typename Ty>
+    Tensor<Ty> gather(const Tensor<Ty> &A, int root);
+
     template<typename Ty>
     Tensor<Ty>
     scatter(const Tensor<Ty> &A, Distribution *distribution, int proc);
 
+    inline void set_reproducible_reduction(bool reproducible);
+
     template<typename Ty>
     double fnorm(const Tensor<Ty> &A);
 
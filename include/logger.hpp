@@ -124,7 +124,7 @@
 
 #define pbp(x)                                                                 \
     do {                                                                       \
-        auto comm = new Communicator<int>();                                   \
+        auto comm = Communicator<int>::instance();                             \
         for (int i = 0; i < comm->size(); i++) {                               \
             comm->barrier();                                                   \
             if (i == comm->rank()) {                                           \
@@ -132,7 +132,6 @@
                 { x; }                                                         \
             }                                                                  \
         }                                                                      \
-        delete comm;                                                           \
     } while (0)
 
 #define print_vec(x)                                                           \
@@ -10,6 +10,8 @@
 template<typename Ty>
 class Operator {
 public:
+    static Operator<Ty> *instance();
+
     static Ty *alloc(size_t);
 
     static void free(Ty *);
@@ -30,39 +32,49 @@ public:
 
     static void rand(Ty *, size_t);
 
+    static void rand(Ty *A, const shape_t &shape, const shape_t &begin,
+                     const shape_t &end);
+
     static void randn(Ty *, size_t);
 
+    static void randn(Ty *A, const shape_t &shape, const shape_t &begin,
+                      const shape_t &end);
+
     static void inverse(Ty *C, Ty *A, size_t n);
 
     static void LQ(Ty *L, Ty *Q, Ty *A, size_t m, size_t n);
 
     static void QR(Ty *Q, Ty *R, Ty *A, size_t m, size_t n);
 
+    static void eig_sym(Ty *V, Ty *w, Ty *A, size_t n);
+
     static void matmulNN(Ty *C, Ty *A, Ty *B, size_t m, size_t n, size_t k);
 
     static void matmulNT(Ty *C, Ty *A, Ty *B, size_t m, size_t n, size_t k);
 
     static void matmulTN(Ty *C, Ty *A, Ty *B, size_t m, size_t n, size_t k);
 
+    static void syrk(Ty *C, Ty *A, size_t m, size_t k);
+
     static void transpose(Ty *B, Ty *A, size_t m, size_t n);
 
+    static void ttm(Ty *C, Ty *A, Ty *M, const shape_t &shape, size_t n,
+                    size_t m, size_t ldm);
+
     static void tenmat(Ty *B, Ty *A, const shape_t &shape, size_t n);
 
     static void tenmatt(Ty *B, Ty *A, const shape_t &shape, size_t n);
 
     static void mattten(Ty *B, Ty *A, const shape_t &shape, size_t n);
 
-    static double fnorm(Ty *, size_t);
+    static void slice(Ty *B, Ty *A, const shape_t &shape,
+                      const shape_t &begin, const shape_t &end);
 
-    static Ty sum(Ty *, size_t);
+    static double fnorm(Ty *, size_t);
 
-    static void reorder_from_gather_cartesian_block(Ty *A, const shape_t &shape,
-                                                    const shape_t &partition,
-                                                    int *displs);
+    static double sqnorm(Ty *, size_t);
 
-    static void reorder_for_scatter_cartesian_block(Ty *A, const shape_t &shape,
-                                                    const shape_t &partition,
-                                                    int *displs);
+    static Ty sum(Ty *, size_t);
 };
 
 template
@@ -77,11 +89,10 @@ class Operator<complex32>;
 template
 class Operator<complex64>;
 
-#define DIANA_OPERATOR_FUNC_START auto recorder_ = Summary::Recorder(METHOD_NAME)
-#define DIANA_OPERATOR_FUNC_START_F(flop) auto recorder_ = Summary::Recorder(METHOD_NAME, flop)
-#define DIANA_OPERATOR_FUNC_START_FW(flop, bandwidth) auto recorder_ = Summary::Recorder(METHOD_NAME, flop, bandwidth)
+#define DIANA_OPERATOR_FUNC_START auto recorder_ = Summary::Recorder(DIANA_EVENT_ID)
+#define DIANA_OPERATOR_FUNC_START_F(flop) auto recorder_ = Summary::Recorder(DIANA_EVENT_ID, flop)
+#define DIANA_OPERATOR_FUNC_START_FW(flop, bandwidth) auto recorder_ = Summary::Recorder(DIANA_EVENT_ID, flop, bandwidth)
 
 #include "operator/operator_cpu.tpp"
-#include "operator/operator_cpu_cartesian_block.tpp"
 
 #endif
\ No newline at end of file
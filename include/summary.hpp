@@ -10,6 +10,9 @@
 #include <mpi.h>
 #include <cmath>
 #include <map>
+#include <atomic>
+#include <memory>
+#include <cstdint>
 
 #include "def.hpp"
 
@@ -21,59 +24,202 @@ inline std::string method_name(const std::string &prettyFunction) {
     return prettyFunction.substr(begin, end) + "()";
 }
 
-#define  METHOD_NAME method_name(__PRETTY_FUNCTION__)
-
-
+/**
+ * Event ID of the enclosing method, interned once per call site on first use,
+ * so that recording an event does not build any string.
+ */
+#define DIANA_EVENT_ID                                                         \
+    ([](const char *pretty_function) {                                         \
+        static const size_t kId = Summary::intern(method_name(pretty_function)); \
+        return kId;                                                            \
+    }(__PRETTY_FUNCTION__))
+
+
+/**
+ * @brief Profiler of the library, recording nested events with their flop and
+ * byte counts.
+ *
+ * Events are identified by IDs interned from their names. Every thread keeps
+ * its own stack of open events, per-ID totals, a table of the communication
+ * between caller and callee IDs and a ring of the most recent
+ * Constant::kSummaryRingSize events, all preallocated, so recording takes no
+ * lock, and allocates only when a thread outgrows them. Timestamps are read from the time stamp counter on
+ * x86-64 and from std::chrono::steady_clock elsewhere.
+ *
+ * Optionally, see enable_counters, every event also reads a group of hardware
+ * counters of its thread through Linux perf_event_open.
+ */
 class Summary {
-private:
-    struct Event {
-        std::string name;
-
-        size_t caller_id;
+public:
+    typedef uint64_t tick_t;
+
+    enum Counter : int {
+        kCycles,
+        kInstructions,
+        kCacheMisses, /**< Last level cache misses. */
+        kFPOps,       /**< Raw PMU event given to enable_counters. */
+        kCounters,
+    };
 
+    struct Record {
+        size_t id;
+        size_t depth;
+        tick_t tick_start;
+        tick_t tick_end;
         long long flop;
         long long bandwidth;
+    };
 
-        double time_start;
-        double time_end;
-        double time_length;
-        double time_counted;
+    /**
+     * @brief Communication of an event and its callees: the payload handed to
+     * and from MPI, the number of MPI operations, and the cost of the
+     * operations in the alpha-beta model, as latency steps and bytes on the
+     * critical path.
+     */
+    struct Traffic {
+        long long sent;
+        long long received;
+        long long messages;
+        long long calls;      /**< Communicator calls. */
+        long long procs;      /**< Sum of the communicator sizes of the calls. */
+        long long steps;
+        double model_bytes;
+        /**
+         * Ticks from the post of the operations to their completion, which
+         * for non-blocking operations includes the time hidden behind
+         * computation.
+         */
+        tick_t tick_flight;
+
+        Traffic &operator+=(const Traffic &other);
+    };
 
-        std::vector<size_t> callee_ids;
+private:
+    struct Frame {
+        size_t id;
+        tick_t tick_start;
+        long long flop;
+        long long bandwidth;
+        size_t alloc_miss;
+        tick_t tick_counted; /**< Ticks spent in callees. */
+        tick_t tick_comm;    /**< Ticks spent in communication callees. */
+        Traffic traffic;
+        /** Time enabled, time running, then every Counter, at the start. */
+        uint64_t counters[2 + kCounters];
+    };
+    struct Statistics {
+        int kind; /**< 0 until classified by is_comm_ on first end. */
+        tick_t tick_length;
+        tick_t tick_counted;
+        tick_t tick_comm; /**< Ticks spent communicating, see is_comm_. */
+        long long flop;
+        long long bandwidth;
+        size_t alloc_miss; /**< Fresh system allocations inside the events. */
+        size_t number;
+        Traffic traffic;
+        double counters[kCounters]; /**< Including the callees. */
+    };
+    struct Edge {
+        size_t caller; /**< SIZE_MAX for an empty slot. */
+        size_t callee;
+        Traffic traffic;
+    };
+    struct Overlap {
+        double time_comm;    /**< Time the communication was in flight. */
+        double time_exposed; /**< Part of it spent blocked in waits. */
+        size_t number;
+    };
+    struct ThreadLog {
+        size_t tid;
+        std::vector<Frame> stack;
+        size_t depth;
+        std::vector<Statistics> statistics;
+        std::vector<Record> ring;
+        size_t recorded; /**< Events ever written to the ring. */
+        /** Non-blocking communication of every event, see overlap. */
+        std::vector<Overlap> overlaps;
+        /**
+         * Communication events called by an event, an open addressing table
+         * keyed by both IDs, at most half full.
+         */
+        std::vector<Edge> edges;
+        size_t edges_used;
+        /** -1 for the counters left out. kCycles leads the group. */
+        int counter_fd[kCounters];
+
+        ~ThreadLog();
     };
-    static std::vector<Event> events_;
-    static std::map<std::string, std::vector<size_t>> events_name_map_;
-    static size_t last_id_;
-    static bool recording_;
+    static std::vector<std::string> names_;
+    static std::vector<std::unique_ptr<ThreadLog>> logs_;
+    static std::atomic<bool> recording_;
+    static double network_latency_;
+    static double network_bandwidth_;
+    static std::atomic<bool> counters_enabled_;
+    static uint64_t counters_fp_config_;
+    static std::string counters_error_;
+
+    static ThreadLog &log_();
+
+    static Traffic &edge_(ThreadLog &log, size_t caller, size_t callee);
+
+    static bool is_comm_(const std::string &name);
+
+    static void open_counters_(ThreadLog &log);
+
+    static void read_counters_(const ThreadLog &log, uint64_t *values);
 
 public:
     class Recorder {
     public:
         Recorder() = delete;
 
-        Recorder(const std::string &name);
+        explicit Recorder(size_t id);
 
-        Recorder(const std::string &name, long long flop);
+        Recorder(size_t id, long long flop);
 
-        Recorder(const std::string &name, long long flop, long long bandwidth);
+        Recorder(size_t id, long long flop, long long bandwidth);
 
         ~Recorder();
 
     private:
-        std::string name_;
+        size_t id_;
     };
 
+    static size_t intern(const std::string &name);
+
+    static std::string name(size_t id);
+
+    static tick_t now();
+
+    static double seconds(tick_t ticks);
+
     static void init();
 
     static void finalize();
 
+    static void start(size_t id, long long flop = 0, long long bandwidth = 0);
+
     static void start(const std::string &name, long long flop = 0,
                       long long bandwidth = 0);
 
+    static void end(size_t id);
+
     static void end(const std::string &name);
 
+    static void traffic(const Traffic &traffic);
+
+    static void complete(size_t id, const Traffic &traffic);
+
+    static void overlap(size_t id, double time_comm, double time_exposed);
+
+    static void set_network_model(double latency, double bandwidth);
+
+    static bool enable_counters(uint64_t fp_config = 0);
+
 
     static void print_summary();
+
+    static void export_trace(const std::string &path, bool merge = true);
 };
 
 #endif //DIANA_TUCKER_SUMMARY_HPP
@@ -7,7 +7,7 @@
 #include "distribution.hpp"
 #include "operator.hpp"
 
-#include <map>
+#include <atomic>
 
 template<typename Ty>
 class Tensor;
@@ -44,7 +44,25 @@ enum Transpose : int {
 template<typename Ty>
 class Tensor {
 private:
+    /**
+     * @brief Data block shared by all tensors viewing the same data.
+     */
+    struct Storage {
+        enum Owner : int {
+            kOperator, /**< data is allocated by Operator<Ty>::alloc. */
+            kExternal, /**< data is an external input, never freed here. */
+        };
+
+        Ty *data;
+        size_t size;
+        Owner owner;
+        std::atomic<int> ref_count;
+
+        Storage(Ty *data, size_t size, Owner owner);
+    };
+
     Ty *data_;
+    Storage *storage_;
     size_t ndim_;
     size_t size_;
     shape_t shape_;
@@ -61,8 +79,6 @@ private:
     int comm_size_;
     int comm_rank_;
 
-    static std::map<Ty *, int> ref_count;
-
     inline void init_by_shape(const shape_t &);
 
     static inline void assert_shape(const Tensor<Ty> &, const Tensor<Ty> &);
@@ -74,6 +90,12 @@ private:
     inline void init_by_distribution(const shape_t &shape_global,
                                      Distribution *distribution);
 
+    inline void init_storage(Ty *data, typename Storage::Owner owner);
+
+    inline void retain_storage();
+
+    inline void release_storage();
+
 public:
     Tensor();
 
@@ -87,9 +109,13 @@ public:
 
     Tensor(const Tensor<Ty> &);
 
+    Tensor(Tensor<Ty> &&) noexcept;
+
     ~Tensor();
 
-    const Tensor<Ty> operator=(const Tensor<Ty> &);
+    Tensor<Ty> &operator=(const Tensor<Ty> &);
+
+    Tensor<Ty> &operator=(Tensor<Ty> &&) noexcept;
 
     inline Ty *data() const;
 
@@ -5,7 +5,13 @@
 
 namespace Util {
 void memcpy(void *, void *, size_t);
-double randn();
+void set_random_seed(uint64_t seed);
+uint64_t random_seed();
+// Streams are handed out in call order, one per random tensor: every process
+// has to create its random tensors in the same order to get the same,
+// partition-independent, values. Thread-safe, but threads racing for streams
+// get them in no particular order.
+uint64_t random_stream();
 size_t calc_size(const shape_t &shape);
 shape_t calc_stride(const shape_t &shape);
 }; // namespace Util
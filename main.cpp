@@ -8,12 +8,17 @@
 #include "logger.hpp"
 #include "algorithm.hpp"
 #include "summary.hpp"
+#include <cstdlib>
 #include <fstream>
+#include <string>
 
 int main(int argc, char *argv[]) {
     mpi_init(argc, argv);
     srand((unsigned int) 20000905);
     std::ifstream fin(argv[1]);
+    // Optional arguments: max_iter and tol.
+    size_t max_iter = argc > 2 ? std::stoul(argv[2]) : 50;
+    double tol = argc > 3 ? std::stod(argv[3]) : 1e-4;
 
     // Init shape
     size_t N;
@@ -34,12 +39,32 @@ int main(int argc, char *argv[]) {
     T.randn();
 
     // Calculate
+    if (std::getenv("DIANA_COUNTERS") != nullptr) {
+        const char *fp = std::getenv("DIANA_COUNTERS_FP");
+        Summary::enable_counters(fp == nullptr ? 0 : std::strtoull(fp, nullptr, 0));
+    }
     Summary::init();
-    auto[G, U] = Algorithm::Tucker::HOOI_ALS(T, R, 5);
+    auto result = Algorithm::Tucker::HOOI_ALS(T, R, max_iter, tol);
     Summary::finalize();
 
+    // Print iterations
+    for (size_t iter = 0; iter < result.iterations.size(); iter++) {
+        const auto &info = result.iterations[iter];
+        size_t comm_bytes = info.comm_bytes;
+        Communicator<size_t>::allreduce_inplace(&comm_bytes, 1, MPI_SUM);
+        output("Iteration " + std::to_string(iter + 1) + ": ||G||_F = " +
+               std::to_string(info.core_norm) + ", residual = " +
+               std::to_string(info.residual) + ", time = " +
+               std::to_string(info.time) + " s, comm = " +
+               std::to_string((double) comm_bytes / 1048576) + " MB");
+    }
+    output(result.converged ? "Converged." : "Reached max_iter.");
+
     // Pring summary
     Summary::print_summary();
+    if (const char *trace = std::getenv("DIANA_TRACE")) {
+        Summary::export_trace(trace, std::getenv("DIANA_TRACE_SPLIT") == nullptr);
+    }
     MPI_Finalize();
     return 0;
 }
\ No newline at end of file
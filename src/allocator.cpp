@@ -0,0 +1,185 @@
+#include "allocator.hpp"
+#include "logger.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+std::atomic<size_t> Allocator::hit_(0);
+std::atomic<size_t> Allocator::miss_(0);
+std::atomic<size_t> Allocator::bytes_in_use_(0);
+std::atomic<size_t> Allocator::bytes_peak_(0);
+std::atomic<size_t> Allocator::bytes_cached_(0);
+std::atomic<size_t> Allocator::cache_limit_(SIZE_MAX);
+
+namespace {
+    /**
+     * Size class of every block obtained from the system allocator, cached
+     * or not, kept out of band so that the blocks start exactly on their
+     * alignment. Guarded by allocator_mutex_, like the free lists.
+     */
+    std::mutex allocator_mutex_;
+    std::unordered_map<void *, size_t> size_classes_;
+    std::unordered_map<size_t, std::vector<void *>> free_lists_;
+
+    /**
+     * Round bytes up to its size class. Four classes per power of two keep
+     * the internal fragmentation below 25%.
+     */
+    size_t size_class_(size_t bytes) {
+        const size_t kMinClass = Constant::kAllocatorAlignment;
+        if (bytes <= kMinClass) {
+            return kMinClass;
+        }
+        size_t high = 1;
+        while (high < bytes) {
+            high <<= 1;
+        }
+        const size_t kStep = high / 8;
+        return DIANA_CEILDIV(bytes, kStep) * kStep;
+    }
+
+    /**
+     * Allocate size_class bytes, not rounded any further: a huge class
+     * starts on a huge page, and only a partial last huge page falls back
+     * to normal pages.
+     */
+    void *system_alloc_(size_t size_class) {
+        size_t alignment = size_class >= Constant::kHugePageSize
+                           ? Constant::kHugePageSize
+                           : Constant::kAllocatorAlignment;
+        void *ptr = nullptr;
+        if (posix_memalign(&ptr, alignment, size_class) != 0) {
+            fatal("Allocator: out of memory.");
+        }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        if (alignment == Constant::kHugePageSize) {
+            madvise(ptr, size_class, MADV_HUGEPAGE);
+        }
+#endif
+        return ptr;
+    }
+} // namespace
+
+/**
+ * @brief Allocate at least bytes bytes, aligned to
+ * Constant::kAllocatorAlignment.
+ *
+ * @param bytes
+ * @return void*
+ */
+void *Allocator::alloc(size_t bytes) {
+    const size_t kClass = size_class_(bytes);
+    void *ptr = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(allocator_mutex_);
+        auto it = free_lists_.find(kClass);
+        if (it != free_lists_.end() && !it->second.empty()) {
+            ptr = it->second.back();
+            it->second.pop_back();
+        }
+    }
+    if (ptr != nullptr) {
+        Allocator::hit_++;
+        Allocator::bytes_cached_ -= kClass;
+    } else {
+        Allocator::miss_++;
+        ptr = system_alloc_(kClass);
+        std::lock_guard<std::mutex> lock(allocator_mutex_);
+        size_classes_[ptr] = kClass;
+    }
+    size_t in_use = Allocator::bytes_in_use_ += kClass;
+    size_t peak = Allocator::bytes_peak_.load();
+    while (in_use > peak &&
+           !Allocator::bytes_peak_.compare_exchange_weak(peak, in_use)) {}
+    return ptr;
+}
+
+/**
+ * @brief Return a block obtained from Allocator::alloc to the cache.
+ *
+ * The block goes back to the system allocator instead when caching it would
+ * exceed the limit set by Allocator::set_cache_limit, or bytes_peak bytes,
+ * so that the cached and used blocks never take more than twice the peak
+ * use, however many size classes it went through.
+ *
+ * @param ptr
+ */
+void Allocator::free(void *ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(allocator_mutex_);
+    auto it = size_classes_.find(ptr);
+    if (it == size_classes_.end()) {
+        fatal("Allocator: free of a block not obtained from Allocator::alloc.");
+    }
+    const size_t kClass = it->second;
+    Allocator::bytes_in_use_ -= kClass;
+    const size_t kLimit = std::min(Allocator::cache_limit_.load(),
+                                   Allocator::bytes_peak_.load());
+    if (Allocator::bytes_cached_ + kClass > kLimit) {
+        size_classes_.erase(it);
+        std::free(ptr);
+        return;
+    }
+    Allocator::bytes_cached_ += kClass;
+    free_lists_[kClass].push_back(ptr);
+}
+
+/**
+ * @brief Give every cached block back to the system allocator.
+ */
+void Allocator::release() {
+    std::lock_guard<std::mutex> lock(allocator_mutex_);
+    for (auto &free_list: free_lists_) {
+        for (void *ptr: free_list.second) {
+            Allocator::bytes_cached_ -= free_list.first;
+            size_classes_.erase(ptr);
+            std::free(ptr);
+        }
+        free_list.second.clear();
+    }
+}
+
+/**
+ * @brief Limit the number of bytes kept in the free lists, on top of the
+ * bytes_peak bound. SIZE_MAX, the default, leaves only that bound.
+ *
+ * @param bytes
+ */
+void Allocator::set_cache_limit(size_t bytes) {
+    Allocator::cache_limit_ = bytes;
+    if (Allocator::bytes_cached_ > bytes) {
+        Allocator::release();
+    }
+}
+
+/**
+ * @brief Number of requests served by the system allocator so far.
+ *
+ * @return size_t
+ */
+size_t Allocator::miss() { return Allocator::miss_; }
+
+Allocator::Statistics Allocator::statistics() {
+    return {
+            Allocator::hit_,
+            Allocator::miss_,
+            Allocator::bytes_in_use_,
+            Allocator::bytes_peak_,
+            Allocator::bytes_cached_
+    };
+}
+
+void Allocator::reset_statistics() {
+    Allocator::hit_ = 0;
+    Allocator::miss_ = 0;
+    Allocator::bytes_peak_.store(Allocator::bytes_in_use_);
+}
@@ -1,4 +1,9 @@
 #include "communicator.hpp"
+#include "summary.hpp"
+#include "logger.hpp"
+
+#include <climits>
+#include <utility>
 
 void mpi_init() { MPI_Init(nullptr, nullptr); }
 
@@ -14,4 +19,171 @@ int mpi_size() {
     int ret;
     MPI_Comm_size(MPI_COMM_WORLD, &ret);
     return ret;
-}
\ No newline at end of file
+}
+
+namespace {
+    size_t mpi_bytes_sent_ = 0;
+    size_t mpi_max_count_ = INT_MAX;
+} // namespace
+
+/**
+ * @brief Bytes this process has handed to MPI as send data through
+ * Communicator so far. This is the payload of the calls, not the traffic of
+ * the algorithms MPI runs for them.
+ *
+ * @return size_t
+ */
+size_t mpi_bytes_sent() { return mpi_bytes_sent_; }
+
+void mpi_add_bytes_sent(size_t bytes) { mpi_bytes_sent_ += bytes; }
+
+/**
+ * @brief Largest count Communicator passes to a single MPI call. Larger
+ * messages are described by a derived datatype, and larger reductions are
+ * split into several calls.
+ *
+ * @return size_t
+ */
+size_t mpi_max_count() { return mpi_max_count_; }
+
+/**
+ * @brief Lower the count passed to a single MPI call, which exercises the
+ * large-count paths of Communicator on small data. Must be the same on all
+ * processes.
+ *
+ * @param count
+ */
+void mpi_set_max_count(size_t count) {
+    assert(count > 0 && count <= INT_MAX);
+    mpi_max_count_ = count;
+}
+Request::Request()
+        : event_(0), traffic_(), tick_start_(0), persistent_(false), native_(false), active_(false) {}
+
+/**
+ * @brief Create a handle posting its operation with start.
+ *
+ * If requests is not empty, they are persistent requests created by MPI_*_init
+ * routines: start is expected to call MPI_Startall on them, and they are
+ * freed with the handle. Otherwise start appends the requests of newly posted
+ * non-blocking operations, and a persistent handle simply posts them again on
+ * every start(). start must stay valid as long as the handle, so it owns any
+ * count arrays the operations use.
+ *
+ * @param event Summary event ID of the operation, see DIANA_EVENT_ID.
+ * @param traffic Communication of the operation. Its send payload is added
+ * to mpi_bytes_sent on every start(), and the whole to Summary on every
+ * wait().
+ * @param start
+ * @param persistent
+ * @param requests
+ */
+Request::Request(size_t event, const Summary::Traffic &traffic,
+                 std::function<void(std::vector<MPI_Request> &)> start,
+                 bool persistent, std::vector<MPI_Request> requests)
+        : requests_(std::move(requests)), event_(event),
+          traffic_(traffic), tick_start_(0), start_(std::move(start)), persistent_(persistent),
+          native_(!this->requests_.empty()), active_(false) {}
+
+Request::Request(Request &&other) noexcept
+        : requests_(std::move(other.requests_)),
+          event_(other.event_), traffic_(other.traffic_),
+          tick_start_(other.tick_start_),
+          start_(std::move(other.start_)), persistent_(other.persistent_),
+          native_(other.native_), active_(other.active_) {
+    other.requests_.clear();
+    other.native_ = false;
+    other.active_ = false;
+}
+
+Request &Request::operator=(Request &&other) noexcept {
+    if (this != &other) {
+        this->release_();
+        this->requests_ = std::move(other.requests_);
+        this->event_ = other.event_;
+        this->traffic_ = other.traffic_;
+        this->tick_start_ = other.tick_start_;
+        this->start_ = std::move(other.start_);
+        this->persistent_ = other.persistent_;
+        this->native_ = other.native_;
+        this->active_ = other.active_;
+        other.requests_.clear();
+        other.native_ = false;
+        other.active_ = false;
+    }
+    return *this;
+}
+
+Request::~Request() { this->release_(); }
+
+void Request::release_() {
+    int finalized;
+    MPI_Finalized(&finalized);
+    if (finalized) {
+        return;
+    }
+    this->wait();
+    if (this->native_) {
+        for (auto &request: this->requests_) {
+            MPI_Request_free(&request);
+        }
+    }
+    this->requests_.clear();
+    this->native_ = false;
+}
+
+void Request::start() {
+    assert(!this->active_);
+    assert(this->persistent_ || this->requests_.empty());
+    mpi_add_bytes_sent((size_t) this->traffic_.sent);
+    if (!this->native_) {
+        this->requests_.clear();
+    }
+    this->tick_start_ = Summary::now();
+    this->start_(this->requests_);
+    this->active_ = true;
+}
+
+void Request::wait() {
+    if (!this->active_) {
+        return;
+    }
+    Summary::start(this->event_);
+    MPI_Waitall((int) this->requests_.size(), this->requests_.data(),
+                MPI_STATUSES_IGNORE);
+    this->complete_();
+    Summary::end(this->event_);
+}
+
+/**
+ * @brief Check whether the operation has completed, driving the progress
+ * of MPI.
+ *
+ * @return true if it is not in flight anymore.
+ */
+bool Request::test() {
+    if (!this->active_) {
+        return true;
+    }
+    int flag;
+    MPI_Testall((int) this->requests_.size(), this->requests_.data(), &flag,
+                MPI_STATUSES_IGNORE);
+    if (flag != 0) {
+        this->complete_();
+    }
+    return !this->active_;
+}
+
+/**
+ * @brief Mark the operation in flight as completed, by wait() or test(), and
+ * record its communication once.
+ */
+void Request::complete_() {
+    assert(this->active_);
+    this->active_ = false;
+    Summary::Traffic traffic = this->traffic_;
+    traffic.tick_flight = Summary::now() - this->tick_start_;
+    Summary::complete(this->event_, traffic);
+}
+
+bool Request::active() const { return this->active_; }
@@ -3,6 +3,7 @@
 #include "logger.hpp"
 #include "communicator.hpp"
 #include <tuple>
+#include <algorithm>
 
 void distribution_assert_valid_input_(const shape_t &global_shape,
                                       const shape_t &local_shape,
@@ -85,11 +86,27 @@ DistributionCartesianBlock::DistributionCartesianBlock(shape_t partition,
         assert(this->coordinate_[i] < this->partition_[i]);
         assert(this->partition_[i] > 0);
     }
+    // MPI orders Cartesian coordinates row-major, so the modes are reversed
+    // to keep the first mode varying fastest, as in coordinate(rank).
+    std::vector<int> dims(this->partition_.rbegin(), this->partition_.rend());
+    size_t processes = 1;
+    for (auto item: partition) {
+        processes *= item;
+    }
+    assert(processes == (size_t) mpi_size());
+    this->process_cart_comm_ =
+            Communicator<void>::cart_create((int) this->ndim_, dims.data());
     for (size_t n = 0; n < this->ndim_; n++) {
-        auto[new_color, new_rank] = this->process_fiber(n);
         this->process_fiber_comm_.push_back(
-                Communicator<void>::comm_split(new_color, new_rank));
+                this->process_grid_comm(shape_t{n}));
+    }
+}
+
+DistributionCartesianBlock::~DistributionCartesianBlock() {
+    for (auto &item: this->process_grid_comm_) {
+        Communicator<void>::comm_free(&item.second);
     }
+    Communicator<void>::comm_free(&this->process_cart_comm_);
 }
 
 shape_t DistributionCartesianBlock::partition() const {
@@ -128,6 +145,33 @@ void DistributionCartesianBlock::get_local_data(const shape_t &global_shape,
     }
 }
 
+/**
+ * Same as get_local_data, for the block of process rank.
+ * @param rank
+ * @param global_shape
+ * @param local_shape
+ * @param local_start
+ * @param local_end
+ */
+void DistributionCartesianBlock::get_local_data(int rank,
+                                                const shape_t &global_shape,
+                                                shape_t &local_shape,
+                                                shape_t &local_start,
+                                                shape_t &local_end) {
+    distribution_assert_valid_input_(global_shape, local_shape, local_start,
+                                     local_end);
+    auto coord = this->coordinate(rank);
+    for (size_t i = 0; i < this->ndim_; i++) {
+        size_t start = DIANA_CEILDIV(global_shape[i] * coord[i],
+                                     this->partition_[i]);
+        size_t end = DIANA_CEILDIV(global_shape[i] * (coord[i] + 1),
+                                   this->partition_[i]);
+        local_start.push_back(start);
+        local_end.push_back(end);
+        local_shape.push_back(end - start);
+    }
+}
+
 void DistributionCartesianBlock::get_local_shape(const shape_t &global_shape,
                                                  shape_t &local_shape) {
     distribution_assert_valid_input_(global_shape, local_shape);
@@ -186,4 +230,49 @@ std::tuple<int, int> DistributionCartesianBlock::process_fiber(size_t n) {
 
 MPI_Comm DistributionCartesianBlock::process_fiber_comm(size_t n) {
     return this->process_fiber_comm_[n];
-}
\ No newline at end of file
+}
+
+/**
+ * Return the communicator of the processes sharing this process' coordinate
+ * on mode n, i.e. the slice of the process grid orthogonal to the n-th fiber.
+ * Ranks in the returned communicator follow process_grid_comm.
+ * The communicator is created on the first call, which is collective.
+ * @param n
+ * @return
+ */
+MPI_Comm DistributionCartesianBlock::process_slice_comm(size_t n) {
+    shape_t modes;
+    for (size_t d = 0; d < this->ndim_; d++) {
+        if (d != n) {
+            modes.push_back(d);
+        }
+    }
+    return this->process_grid_comm(modes);
+}
+
+/**
+ * Return the communicator of the processes sharing this process' coordinates
+ * on every mode except the given ones, i.e. the sub-grid spanned by modes.
+ * Ranks in the returned communicator are the coordinates on modes linearized
+ * in ascending mode order, the smallest mode varying fastest.
+ * The communicator is created by MPI_Cart_sub on the first call, which is
+ * collective, and freed with the distribution.
+ * @param modes
+ * @return
+ */
+MPI_Comm DistributionCartesianBlock::process_grid_comm(const shape_t &modes) {
+    shape_t key_modes(modes);
+    std::sort(key_modes.begin(), key_modes.end());
+    auto it = this->process_grid_comm_.find(key_modes);
+    if (it != this->process_grid_comm_.end()) {
+        return it->second;
+    }
+    std::vector<int> remain_dims(this->ndim_, 0);
+    for (auto d: key_modes) {
+        remain_dims[this->ndim_ - 1 - d] = 1;
+    }
+    MPI_Comm comm = Communicator<void>::cart_sub(this->process_cart_comm_,
+                                                 remain_dims.data());
+    this->process_grid_comm_[key_modes] = comm;
+    return comm;
+}
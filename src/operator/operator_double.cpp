@@ -5,9 +5,11 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <vector>
 
 #ifdef DIANA_MKL
 extern "C" {
+#include "mkl_version.h"
 #include "mkl_cblas.h"
 #include "mkl_lapacke.h"
 }
@@ -20,72 +22,6 @@ extern "C" {
 #endif
 #endif
 
-template<>
-void Operator<double>::add(double *C, double *A, double *B, size_t n) {
-    DIANA_OPERATOR_FUNC_START;
-    for (size_t i = 0; i < n; i++) {
-        C[i] = A[i] + B[i];
-    }
-}
-
-template<>
-void Operator<double>::sub(double *C, double *A, double *B, size_t n) {
-    DIANA_OPERATOR_FUNC_START;
-    for (size_t i = 0; i < n; i++) {
-        C[i] = A[i] - B[i];
-    }
-}
-
-template<>
-void Operator<double>::mul(double *C, double *A, double *B, size_t n) {
-    DIANA_OPERATOR_FUNC_START;
-    for (size_t i = 0; i < n; i++) {
-        C[i] = A[i] * B[i];
-    }
-}
-
-template<>
-void Operator<double>::nmul(double *C, double *A, double B, size_t n) {
-    DIANA_OPERATOR_FUNC_START;
-    for (size_t i = 0; i < n; i++) {
-        C[i] = A[i] * B;
-    }
-}
-
-template<>
-void Operator<double>::constant(double *A, double c, size_t n) {
-    DIANA_OPERATOR_FUNC_START;
-    for (size_t i = 0; i < n; i++) {
-        A[i] = c;
-    }
-}
-
-template<>
-void Operator<double>::rand(double *A, size_t n) {
-    DIANA_OPERATOR_FUNC_START;
-    for (size_t i = 0; i < n; i++) {
-        A[i] = (double) std::rand() / RAND_MAX;
-    }
-}
-
-template<>
-void Operator<double>::randn(double *A, size_t n) {
-    DIANA_OPERATOR_FUNC_START;
-    for (size_t i = 0; i < n; i++) {
-        A[i] = Util::randn();
-    }
-}
-
-template<>
-double Operator<double>::fnorm(double *A, size_t n) {
-    DIANA_OPERATOR_FUNC_START;
-    double ret = 0;
-    for (size_t i = 0; i < n; i++) {
-        ret += A[i] * A[i];
-    }
-    return std::sqrt(ret);
-}
-
 template<>
 void
 Operator<double>::inverse(double *C, double *A, size_t m) {
@@ -109,7 +45,7 @@ Operator<double>::inverse(double *C, double *A, size_t m) {
 template<>
 void Operator<double>::LQ(double *L, double *Q, double *A, size_t m, size_t n) {
 #ifdef DIANA_LAPACK
-    Summary::start(METHOD_NAME);
+    Summary::start(DIANA_EVENT_ID);
     auto M = (lapack_int) m;
     auto N = (lapack_int) n;
     lapack_int LDA = M;
@@ -126,7 +62,7 @@ void Operator<double>::LQ(double *L, double *Q, double *A, size_t m, size_t n) {
     INFO = LAPACKE_dorglq(LAPACK_COL_MAJOR, M, N, K, Q, LDA, TAU);
     checkwarn(INFO == 0);
     Operator<double>::free(TAU);
-    Summary::end(METHOD_NAME);
+    Summary::end(DIANA_EVENT_ID);
 #else
     fatal("Cannot calculate inverse without BLAS!");
 #endif
@@ -135,7 +71,7 @@ void Operator<double>::LQ(double *L, double *Q, double *A, size_t m, size_t n) {
 template<>
 void Operator<double>::QR(double *Q, double *R, double *A, size_t m, size_t n) {
 #ifdef DIANA_LAPACK
-    Summary::start(METHOD_NAME);
+    Summary::start(DIANA_EVENT_ID);
     auto M = (lapack_int) m;
     auto N = (lapack_int) n;
     lapack_int LDA = M;
@@ -152,17 +88,33 @@ void Operator<double>::QR(double *Q, double *R, double *A, size_t m, size_t n) {
     INFO = LAPACKE_dorgqr(LAPACK_COL_MAJOR, M, N, K, Q, LDA, TAU);
     checkwarn(INFO == 0);
     Operator<double>::free(TAU);
-    Summary::end(METHOD_NAME);
+    Summary::end(DIANA_EVENT_ID);
 #else
     fatal("Cannot calculate inverse without BLAS!");
 #endif
 }
 
+template<>
+void Operator<double>::eig_sym(double *V, double *w, double *A, size_t n) {
+#ifdef DIANA_LAPACK
+    Summary::start(DIANA_EVENT_ID);
+    auto N = (lapack_int) n;
+    lapack_int LDA = N;
+    lapack_int INFO;
+    Operator<double>::mcpy(V, A, n * n);
+    INFO = LAPACKE_dsyev(LAPACK_COL_MAJOR, 'V', 'U', N, V, LDA, w);
+    checkwarn(INFO == 0);
+    Summary::end(DIANA_EVENT_ID);
+#else
+    fatal("Cannot calculate eig_sym without LAPACK!");
+#endif
+}
+
 template<>
 void Operator<double>::matmulNN(double *C, double *A, double *B, size_t m,
                                 size_t n, size_t k) {
 #ifdef DIANA_BLAS
-    Summary::start(METHOD_NAME, 2 * (long long) m * (long long) n *
+    Summary::start(DIANA_EVENT_ID, 2 * (long long) m * (long long) n *
                                 (long long) k);
     double alpha = 1.0;
     int lda = (int) m;
@@ -171,7 +123,7 @@ void Operator<double>::matmulNN(double *C, double *A, double *B, size_t m,
     int ldc = (int) m;
     cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, (int) m, (int) n,
                 (int) k, alpha, A, lda, B, ldb, beta, C, ldc);
-    Summary::end(METHOD_NAME);
+    Summary::end(DIANA_EVENT_ID);
 #else
     fatal("Cannot calculate matmulNN without BLAS!");
 #endif
@@ -181,7 +133,7 @@ template<>
 void Operator<double>::matmulNT(double *C, double *A, double *B, size_t m,
                                 size_t n, size_t k) {
 #ifdef DIANA_BLAS
-    Summary::start(METHOD_NAME, 2 * (long long) m * (long long) n *
+    Summary::start(DIANA_EVENT_ID, 2 * (long long) m * (long long) n *
                                 (long long) k);
     double alpha = 1.0;
     int lda = (int) m;
@@ -191,18 +143,110 @@ void Operator<double>::matmulNT(double *C, double *A, double *B, size_t m,
     cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, (int) m, (int) n,
                 (int) k,
                 alpha, A, lda, B, ldb, beta, C, ldc);
-    Summary::end(METHOD_NAME);
+    Summary::end(DIANA_EVENT_ID);
 #else
     fatal("Cannot calculate matmulNT without BLAS!");
 #endif
 }
 
+/**
+ * @brief Let the upper triangle of \f$ \bm{C} \f$ be \f$ \bm{A} \bm{A}^T
+ * \f$, where \f$ \bm{A} \f$ is of shape \f$ m \times k \f$. The strictly
+ * lower triangle of \f$ \bm{C} \f$ is left untouched.
+ */
+template<>
+void Operator<double>::syrk(double *C, double *A, size_t m, size_t k) {
+#ifdef DIANA_BLAS
+    Summary::start(DIANA_EVENT_ID, (long long) m * (long long) (m + 1) *
+                                (long long) k);
+    cblas_dsyrk(CblasColMajor, CblasUpper, CblasNoTrans, (int) m, (int) k,
+                1.0, A, (int) m, 0.0, C, (int) m);
+    Summary::end(DIANA_EVENT_ID);
+#else
+    fatal("Cannot calculate syrk without BLAS!");
+#endif
+}
+
+
+/**
+ * @brief Let \f$ \bm{\mathcal{C}} = \bm{\mathcal{A}} \times_n \bm{M} \f$
+ * without matricizing \f$ \bm{\mathcal{A}} \f$.
+ *
+ * The column major tensor \f$ \bm{\mathcal{A}} \f$ is viewed as a batch of
+ * \f$ \prod_{i > n} I_i \f$ matrices of shape
+ * \f$ \prod_{i < n} I_i \times I_n \f$, each of which is multiplied by
+ * \f$ \bm{M}^T \f$ in place of its slot in \f$ \bm{\mathcal{C}} \f$.
+ *
+ * @param C Tensor of shape, with shape[n] replaced by m.
+ * @param A Tensor of shape.
+ * @param M Matrix of shape \f$ m \times I_n \f$, leading dimension ldm.
+ * @param shape
+ * @param n
+ * @param m
+ * @param ldm
+ */
+template<>
+void Operator<double>::ttm(double *C, double *A, double *M,
+                           const shape_t &shape, size_t n, size_t m,
+                           size_t ldm) {
+#ifdef DIANA_BLAS
+    auto[bc, br, after] = operator_split_shape_(shape, n);
+    Summary::start(DIANA_EVENT_ID, 2 * (long long) bc * (long long) br *
+                                (long long) after * (long long) m);
+    if (bc == 1) {
+        // C (m x after) = M (m x br) * A (br x after).
+        cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, (int) m,
+                    (int) after, (int) br, 1.0, M, (int) ldm, A, (int) br,
+                    0.0, C, (int) m);
+    } else {
+        // C_a (bc x m) = A_a (bc x br) * M^T (br x m), for every a < after.
+#if defined(DIANA_MKL) && INTEL_MKL_VERSION >= 20200000
+        cblas_dgemm_batch_strided(CblasColMajor, CblasNoTrans, CblasTrans,
+                                  (int) bc, (int) m, (int) br, 1.0,
+                                  A, (int) bc, (int) (bc * br),
+                                  M, (int) ldm, 0,
+                                  0.0, C, (int) bc, (int) (bc * m),
+                                  (int) after);
+#elif defined(DIANA_MKL)
+        std::vector<const double *> A_array(after);
+        std::vector<const double *> M_array(after, M);
+        std::vector<double *> C_array(after);
+        for (size_t a = 0; a < after; a++) {
+            A_array[a] = A + a * bc * br;
+            C_array[a] = C + a * bc * m;
+        }
+        const CBLAS_TRANSPOSE kTransA = CblasNoTrans;
+        const CBLAS_TRANSPOSE kTransB = CblasTrans;
+        const auto kM = (MKL_INT) bc;
+        const auto kN = (MKL_INT) m;
+        const auto kK = (MKL_INT) br;
+        const auto kLdm = (MKL_INT) ldm;
+        const auto kGroupSize = (MKL_INT) after;
+        const double kAlpha = 1.0;
+        const double kBeta = 0.0;
+        cblas_dgemm_batch(CblasColMajor, &kTransA, &kTransB, &kM, &kN, &kK,
+                          &kAlpha, A_array.data(), &kM, M_array.data(),
+                          &kLdm, &kBeta, C_array.data(), &kM, 1,
+                          &kGroupSize);
+#else
+        for (size_t a = 0; a < after; a++) {
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, (int) bc,
+                        (int) m, (int) br, 1.0, A + a * bc * br, (int) bc,
+                        M, (int) ldm, 0.0, C + a * bc * m, (int) bc);
+        }
+#endif
+    }
+    Summary::end(DIANA_EVENT_ID);
+#else
+    fatal("Cannot calculate ttm without BLAS!");
+#endif
+}
 
 template<>
 void Operator<double>::matmulTN(double *C, double *A, double *B, size_t m,
                                 size_t n, size_t k) {
 #ifdef DIANA_BLAS
-    Summary::start(METHOD_NAME, 2 * (long long) m * (long long) n *
+    Summary::start(DIANA_EVENT_ID, 2 * (long long) m * (long long) n *
                                 (long long) k);
     double alpha = 1.0;
     int lda = (int) k;
@@ -212,7 +256,7 @@ void Operator<double>::matmulTN(double *C, double *A, double *B, size_t m,
     cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, (int) m, (int) n,
                 (int) k,
                 alpha, A, lda, B, ldb, beta, C, ldc);
-    Summary::end(METHOD_NAME);
+    Summary::end(DIANA_EVENT_ID);
 #else
     fatal("Cannot calculate matmulNT without BLAS!");
 #endif
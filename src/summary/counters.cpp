@@ -0,0 +1,133 @@
+//
+// Hardware counters of the Summary events, through Linux perf_event_open.
+//
+
+#include "summary.hpp"
+#include "logger.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__) && __has_include(<linux/perf_event.h>)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define DIANA_SUMMARY_PERF
+#endif
+
+std::atomic<bool> Summary::counters_enabled_(false);
+uint64_t Summary::counters_fp_config_ = 0;
+std::string Summary::counters_error_ = "not enabled";
+
+#ifdef DIANA_SUMMARY_PERF
+namespace {
+    /**
+     * Open a counter of the calling thread in user space, joining the group
+     * of leader, or leading a new group if leader is -1.
+     */
+    int counters_open_(uint32_t type, uint64_t config, int leader) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return (int) syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+    }
+} // namespace
+#endif
+
+Summary::ThreadLog::~ThreadLog() {
+#ifdef DIANA_SUMMARY_PERF
+    for (int fd: this->counter_fd) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+#endif
+}
+
+/**
+ * @brief Read the hardware counters of every event from now on, see
+ * Summary::Counter. The events of each thread count that thread only, so a
+ * kernel running OpenMP threads counts the share of its calling thread.
+ *
+ * fp_config is the raw PMU event counting floating-point operations, which
+ * is model specific, e.g. FP_ARITH_INST_RETIRED on Intel; 0 leaves kFPOps
+ * out, and flop rates then use the estimates passed to Summary::start.
+ * Counters the PMU does not expose are left out too.
+ *
+ * @param fp_config
+ * @return true if the counters of the calling thread could be opened;
+ * otherwise events are recorded without them.
+ */
+bool Summary::enable_counters(uint64_t fp_config) {
+    Summary::counters_fp_config_ = fp_config;
+    Summary::counters_enabled_ = true;
+    ThreadLog &log = Summary::log_();
+    if (log.counter_fd[kCycles] < 0) {
+        Summary::open_counters_(log);
+    }
+    return log.counter_fd[kCycles] >= 0;
+}
+
+/**
+ * @brief Open the counter group of the thread of log, if enabled. On failure
+ * the thread records no counters and the reason is kept for print_summary.
+ */
+void Summary::open_counters_(ThreadLog &log) {
+    for (int &fd: log.counter_fd) {
+        fd = -1;
+    }
+    if (!Summary::counters_enabled_) {
+        return;
+    }
+#ifdef DIANA_SUMMARY_PERF
+    const int kLeader =
+            counters_open_(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+    if (kLeader < 0) {
+        Summary::counters_error_ =
+                std::string("perf_event_open: ") + std::strerror(errno);
+        return;
+    }
+    log.counter_fd[kCycles] = kLeader;
+    const std::pair<uint32_t, uint64_t> kMembers[] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_RAW,      Summary::counters_fp_config_},
+    };
+    for (int counter = kInstructions; counter < kCounters; counter++) {
+        const auto &member = kMembers[counter - kInstructions];
+        if (member.first != PERF_TYPE_RAW || member.second != 0) {
+            log.counter_fd[counter] =
+                    counters_open_(member.first, member.second, kLeader);
+        }
+    }
+    Summary::counters_error_.clear();
+#else
+    Summary::counters_error_ = "perf_event_open is not supported";
+#endif
+}
+
+/**
+ * @brief Read the counter group of log into values: time enabled, time
+ * running, then every Counter, 0 for those left out.
+ */
+void Summary::read_counters_(const ThreadLog &log, uint64_t *values) {
+    uint64_t buffer[3 + kCounters] = {};
+#ifdef DIANA_SUMMARY_PERF
+    if (read(log.counter_fd[kCycles], buffer, sizeof(buffer)) < 0) {
+        std::memset(buffer, 0, sizeof(buffer));
+    }
+#endif
+    values[0] = buffer[1];
+    values[1] = buffer[2];
+    // Members of the group are read in the order they were opened.
+    size_t slot = 3;
+    for (int counter = 0; counter < kCounters; counter++) {
+        values[2 + counter] = log.counter_fd[counter] < 0 ? 0 : buffer[slot++];
+    }
+}
@@ -4,22 +4,21 @@
 
 #include "summary.hpp"
 
-Summary::Recorder::Recorder(const std::string &name) {
-    this->name_ = name;
-    Summary::start(name);
+Summary::Recorder::Recorder(size_t id) {
+    this->id_ = id;
+    Summary::start(id);
 }
 
-Summary::Recorder::Recorder(const std::string &name, long long flop) {
-    this->name_ = name;
-    Summary::start(name, flop);
+Summary::Recorder::Recorder(size_t id, long long flop) {
+    this->id_ = id;
+    Summary::start(id, flop);
 }
 
-Summary::Recorder::Recorder(const std::string &name, long long flop,
-                            long long bandwidth) {
-    this->name_ = name;
-    Summary::start(name, flop, bandwidth);
+Summary::Recorder::Recorder(size_t id, long long flop, long long bandwidth) {
+    this->id_ = id;
+    Summary::start(id, flop, bandwidth);
 }
 
 Summary::Recorder::~Recorder() {
-    Summary::end(this->name_);
-}
\ No newline at end of file
+    Summary::end(this->id_);
+}
@@ -2,70 +2,524 @@
 // Created by 丁明朔 on 2022/3/3.
 //
 
+#include <algorithm>
 #include <queue>
+#include <set>
 #include <iostream>
 
 #include "summary.hpp"
 #include "logger.hpp"
 #include "communicator.hpp"
+#include "allocator.hpp"
 
-#define ROOT_ID SIZE_MAX
-std::vector<Summary::Event> Summary::events_ = std::vector<Summary::Event>();
-std::map<std::string, std::vector<size_t>>  Summary::events_name_map_ =
-        std::map<std::string, std::vector<size_t>>();
-size_t Summary::last_id_ = ROOT_ID;
-bool Summary::recording_ = false;
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define DIANA_SUMMARY_RDTSC
+#endif
+
+std::vector<std::string> Summary::names_ = std::vector<std::string>();
+std::vector<std::unique_ptr<Summary::ThreadLog>> Summary::logs_ =
+        std::vector<std::unique_ptr<Summary::ThreadLog>>();
+std::atomic<bool> Summary::recording_(false);
+double Summary::network_latency_ = Constant::kNetworkLatency;
+double Summary::network_bandwidth_ = Constant::kNetworkBandwidth;
+
+namespace {
+    const int kSummaryCompute = 1;
+    const int kSummaryComm = 2;
+
+    std::mutex summary_mutex_;
+    std::unordered_map<std::string, size_t> summary_ids_;
+
+    // Calibration of the ticks against std::chrono::steady_clock.
+    Summary::tick_t summary_tick_origin_ = 0;
+    std::chrono::steady_clock::time_point summary_clock_origin_;
+    double summary_tick_rate_ = 0;
+    // MPI_Wtime at the tick origin, to align the traces of the processes.
+    double summary_wtime_origin_ = 0;
+
+    double summary_elapsed_(std::chrono::steady_clock::time_point origin) {
+        return std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - origin).count();
+    }
+
+    void summary_calibrate_() {
+        summary_clock_origin_ = std::chrono::steady_clock::now();
+        summary_tick_origin_ = Summary::now();
+#ifdef DIANA_SUMMARY_RDTSC
+        // Refined by summary_tick_rate_now_, over a longer interval.
+        while (summary_elapsed_(summary_clock_origin_) <
+               Constant::kSummaryCalibration) {}
+        summary_tick_rate_ =
+                (double) (Summary::now() - summary_tick_origin_) /
+                summary_elapsed_(summary_clock_origin_);
+#else
+        summary_tick_rate_ = 1e9;
+#endif
+    }
+
+    double summary_tick_rate_now_() {
+#ifdef DIANA_SUMMARY_RDTSC
+        double elapsed = summary_elapsed_(summary_clock_origin_);
+        if (elapsed > 10 * Constant::kSummaryCalibration) {
+            summary_tick_rate_ =
+                    (double) (Summary::now() - summary_tick_origin_) / elapsed;
+        }
+#endif
+        return summary_tick_rate_;
+    }
+} // namespace
+
+/**
+ * @brief Get the ID of the event name, registering it on first use. Call
+ * sites are expected to keep the ID, see DIANA_EVENT_ID.
+ *
+ * @param name
+ * @return size_t
+ */
+size_t Summary::intern(const std::string &name) {
+    std::lock_guard<std::mutex> lock(summary_mutex_);
+    auto it = summary_ids_.find(name);
+    if (it != summary_ids_.end()) {
+        return it->second;
+    }
+    Summary::names_.push_back(name);
+    summary_ids_[name] = Summary::names_.size() - 1;
+    return Summary::names_.size() - 1;
+}
+
+/**
+ * @brief Get the name of the event id. Returned by value, since another
+ * thread may intern a name meanwhile and reallocate the names.
+ *
+ * @param id
+ * @return std::string
+ */
+std::string Summary::name(size_t id) {
+    std::lock_guard<std::mutex> lock(summary_mutex_);
+    return Summary::names_[id];
+}
+
+Summary::tick_t Summary::now() {
+#ifdef DIANA_SUMMARY_RDTSC
+    return __rdtsc();
+#else
+    return (Summary::tick_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * @brief Convert a number of ticks to seconds.
+ *
+ * @param ticks
+ * @return double
+ */
+double Summary::seconds(Summary::tick_t ticks) {
+    if (summary_tick_rate_ == 0) {
+        summary_calibrate_();
+    }
+    return (double) ticks / summary_tick_rate_now_();
+}
+
+Summary::Traffic &Summary::Traffic::operator+=(const Traffic &other) {
+    this->sent += other.sent;
+    this->received += other.received;
+    this->messages += other.messages;
+    this->calls += other.calls;
+    this->procs += other.procs;
+    this->steps += other.steps;
+    this->model_bytes += other.model_bytes;
+    this->tick_flight += other.tick_flight;
+    return *this;
+}
+
+/**
+ * @brief Whether the event name is a communication, i.e. a Communicator
+ * call or the wait of a Request, whose time counts as waiting in the
+ * load-balance report.
+ */
+bool Summary::is_comm_(const std::string &name) {
+    return name.rfind("Communicator<", 0) == 0;
+}
+
+/**
+ * @brief Get the log of the calling thread, registering it on first use.
+ * Its buffers are allocated once, here.
+ */
+Summary::ThreadLog &Summary::log_() {
+    thread_local ThreadLog *log = nullptr;
+    if (log == nullptr) {
+        std::lock_guard<std::mutex> lock(summary_mutex_);
+        Summary::logs_.push_back(std::make_unique<ThreadLog>());
+        log = Summary::logs_.back().get();
+        log->tid = Summary::logs_.size() - 1;
+        log->stack.resize(Constant::kSummaryDepth);
+        log->depth = 0;
+        log->statistics.resize(Constant::kSummaryEvents);
+        log->overlaps.resize(Constant::kSummaryEvents);
+        log->edges.assign(Constant::kSummaryEdges, Edge{SIZE_MAX, 0, {}});
+        log->edges_used = 0;
+        log->ring.resize(Constant::kSummaryRingSize);
+        log->recorded = 0;
+        Summary::open_counters_(*log);
+    }
+    return *log;
+}
+
+/**
+ * @brief Get the traffic of the calls from caller to callee in the table of
+ * log, inserting it if new. The table doubles when it would get more than
+ * half full, the only time it allocates.
+ */
+Summary::Traffic &Summary::edge_(ThreadLog &log, size_t caller,
+                                 size_t callee) {
+    const size_t kMask = log.edges.size() - 1;
+    size_t slot = (caller * Constant::kSummaryEvents + callee) & kMask;
+    while (log.edges[slot].caller != SIZE_MAX) {
+        if (log.edges[slot].caller == caller &&
+            log.edges[slot].callee == callee) {
+            return log.edges[slot].traffic;
+        }
+        slot = (slot + 1) & kMask;
+    }
+    if (2 * (log.edges_used + 1) > log.edges.size()) {
+        std::vector<Edge> edges(2 * log.edges.size(), Edge{SIZE_MAX, 0, {}});
+        edges.swap(log.edges);
+        log.edges_used = 0;
+        for (const Edge &edge: edges) {
+            if (edge.caller != SIZE_MAX) {
+                Summary::edge_(log, edge.caller, edge.callee) = edge.traffic;
+            }
+        }
+        return Summary::edge_(log, caller, callee);
+    }
+    log.edges_used++;
+    log.edges[slot].caller = caller;
+    log.edges[slot].callee = callee;
+    return log.edges[slot].traffic;
+}
 
 void Summary::init() {
+    // Processes leave the barrier together, which aligns their tick origins.
+    MPI_Barrier(MPI_COMM_WORLD);
+    summary_calibrate_();
+    summary_wtime_origin_ = MPI_Wtime();
     Summary::recording_ = true;
-    Summary::start("{Main}");
+    Summary::start(Summary::intern("{Main}"));
 }
 
 void Summary::finalize() {
-    Summary::end("{Main}");
+    Summary::end(Summary::intern("{Main}"));
     Summary::recording_ = false;
 }
 
-void
-Summary::start(const std::string &name, long long flop,
-               long long bandwidth) {
-    if (!Summary::recording_) {
+void Summary::start(size_t id, long long flop, long long bandwidth) {
+    if (!Summary::recording_.load(std::memory_order_relaxed)) {
         return;
     }
-    Summary::events_.push_back({
-                                       name,
-                                       Summary::last_id_,
-                                       flop,
-                                       bandwidth,
-                                       MPI_Wtime(),
-                                       0,
-                                       0,
-                                       0,
-                                       std::vector<size_t>()
-                               });
-    Summary::last_id_ = events_.size() - 1;
-    Summary::events_name_map_[name].push_back(Summary::last_id_);
-}
-
-void
-Summary::end(const std::string &name) {
-    if (!Summary::recording_) {
+    ThreadLog &log = Summary::log_();
+    if (log.depth == log.stack.size()) {
+        log.stack.resize(2 * log.stack.size());
+    }
+    log.stack[log.depth++] = {id, 0, flop, bandwidth, Allocator::miss(), 0,
+                             0, {}, {}};
+    if (log.counter_fd[kCycles] >= 0) {
+        Summary::read_counters_(log, log.stack[log.depth - 1].counters);
+    }
+    // Read the clock last, so that the bookkeeping is not timed.
+    log.stack[log.depth - 1].tick_start = Summary::now();
+}
+
+void Summary::start(const std::string &name, long long flop,
+                    long long bandwidth) {
+    if (!Summary::recording_.load(std::memory_order_relaxed)) {
         return;
     }
-    size_t idx = Summary::last_id_;
-    Summary::Event &event = Summary::events_[idx];
-    assert(event.name == name);
-    event.time_end = MPI_Wtime();
-    event.time_length = event.time_end - event.time_start;
-    Summary::last_id_ = event.caller_id;
-    if (Summary::last_id_ != ROOT_ID) {
-        // If last_id_ is not root, then gather the data to the caller.
-        Summary::Event &caller_event = Summary::events_[Summary::last_id_];
-        caller_event.callee_ids.push_back(idx);
-        caller_event.flop += event.flop;
-        caller_event.bandwidth += event.bandwidth;
-        caller_event.time_counted += event.time_length;
+    Summary::start(Summary::intern(name), flop, bandwidth);
+}
+
+void Summary::end(size_t id) {
+    const tick_t kTickEnd = Summary::now();
+    if (!Summary::recording_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    ThreadLog &log = Summary::log_();
+    if (log.depth == 0) {
+        // Started before recording began.
+        return;
+    }
+    const Frame &frame = log.stack[--log.depth];
+    assert(frame.id == id);
+    const tick_t kLength = kTickEnd - frame.tick_start;
+    if (id >= log.statistics.size()) {
+        log.statistics.resize(std::max(id + 1, 2 * log.statistics.size()));
+    }
+    Statistics &statistics = log.statistics[id];
+    if (statistics.kind == 0) {
+        statistics.kind = Summary::is_comm_(Summary::name(id))
+                          ? kSummaryComm : kSummaryCompute;
+    }
+    // The whole of a communication counts as such, whatever it calls.
+    const tick_t kTickComm =
+            statistics.kind == kSummaryComm ? kLength : frame.tick_comm;
+    statistics.tick_length += kLength;
+    statistics.tick_counted += frame.tick_counted;
+    statistics.tick_comm += kTickComm;
+    Traffic traffic = frame.traffic;
+    if (statistics.kind == kSummaryComm && traffic.calls != 0 &&
+        traffic.tick_flight == 0) {
+        // A blocking call, in flight for its whole length.
+        traffic.tick_flight = kLength;
+    }
+    statistics.flop += frame.flop;
+    statistics.bandwidth += frame.bandwidth;
+    statistics.alloc_miss += Allocator::miss() - frame.alloc_miss;
+    statistics.number++;
+    statistics.traffic += traffic;
+    if (log.counter_fd[kCycles] >= 0) {
+        uint64_t counters[2 + kCounters];
+        Summary::read_counters_(log, counters);
+        // Scale for the time the group was multiplexed out.
+        const uint64_t kEnabled = counters[0] - frame.counters[0];
+        const uint64_t kRunning = counters[1] - frame.counters[1];
+        for (int counter = 0; kRunning != 0 && counter < kCounters;
+             counter++) {
+            statistics.counters[counter] +=
+                    (double) (counters[2 + counter] -
+                              frame.counters[2 + counter]) *
+                    (double) kEnabled / (double) kRunning;
+        }
+    }
+    log.ring[log.recorded % log.ring.size()] = {id, log.depth,
+                                                frame.tick_start, kTickEnd,
+                                                frame.flop, frame.bandwidth};
+    log.recorded++;
+    if (log.depth != 0) {
+        // Gather the data to the caller.
+        Frame &caller = log.stack[log.depth - 1];
+        caller.flop += frame.flop;
+        caller.bandwidth += frame.bandwidth;
+        caller.tick_counted += kLength;
+        caller.tick_comm += kTickComm;
+        caller.traffic += traffic;
+        if (statistics.kind == kSummaryComm && traffic.calls != 0) {
+            Summary::edge_(log, caller.id, id) += traffic;
+        }
+    }
+}
+
+void Summary::end(const std::string &name) {
+    if (!Summary::recording_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    Summary::end(Summary::intern(name));
+}
+
+/**
+ * @brief Add the communication of a Communicator call to the innermost open
+ * event of the calling thread, from which it is gathered to the callers.
+ *
+ * @param traffic
+ */
+void Summary::traffic(const Traffic &traffic) {
+    if (!Summary::recording_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    ThreadLog &log = Summary::log_();
+    if (log.depth != 0) {
+        log.stack[log.depth - 1].traffic += traffic;
+    }
+}
+
+/**
+ * @brief Record the communication of the non-blocking operation id, which
+ * has just completed. It is added to the event id if that is the innermost
+ * open event, i.e. the operation completed in its wait; otherwise, as when it
+ * completed in a test, it is gathered to the innermost open event as if it
+ * had been called from there.
+ *
+ * @param id
+ * @param traffic
+ */
+void Summary::complete(size_t id, const Traffic &traffic) {
+    if (!Summary::recording_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    ThreadLog &log = Summary::log_();
+    if (log.depth == 0) {
+        return;
+    }
+    Frame &caller = log.stack[log.depth - 1];
+    caller.traffic += traffic;
+    if (caller.id == id) {
+        return;
+    }
+    if (id >= log.statistics.size()) {
+        log.statistics.resize(std::max(id + 1, 2 * log.statistics.size()));
+    }
+    log.statistics[id].traffic += traffic;
+    Summary::edge_(log, caller.id, id) += traffic;
+}
+
+/**
+ * @brief Set the parameters of the alpha-beta model the communication is
+ * compared against: the latency of a message in seconds and the bandwidth of
+ * a link in bytes per second. Defaults to Constant::kNetworkLatency and
+ * Constant::kNetworkBandwidth.
+ *
+ * @param latency
+ * @param bandwidth
+ */
+void Summary::set_network_model(double latency, double bandwidth) {
+    assert(latency >= 0 && bandwidth > 0);
+    Summary::network_latency_ = latency;
+    Summary::network_bandwidth_ = bandwidth;
+}
+
+/**
+ * @brief Record a non-blocking communication of the kernel id which was in
+ * flight for time_comm seconds, time_exposed of which were spent blocked in
+ * waits, so that the rest was hidden behind computation.
+ *
+ * @param id
+ * @param time_comm
+ * @param time_exposed
+ */
+void Summary::overlap(size_t id, double time_comm, double time_exposed) {
+    if (!Summary::recording_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    ThreadLog &log = Summary::log_();
+    if (id >= log.overlaps.size()) {
+        log.overlaps.resize(std::max(id + 1, 2 * log.overlaps.size()));
+    }
+    Overlap &overlap = log.overlaps[id];
+    overlap.time_comm += time_comm;
+    overlap.time_exposed += std::min(time_exposed, time_comm);
+    overlap.number++;
+}
+
+std::string summary_json_escape_(const std::string &s) {
+    std::string ret;
+    for (char c: s) {
+        if (c == '"' || c == '\\') {
+            ret += '\\';
+        }
+        ret += c;
+    }
+    return ret;
+}
+
+/**
+ * @brief Write the recorded events of every process as a Chrome Trace Event
+ * JSON file, which chrome://tracing and https://ui.perfetto.dev open.
+ * Processes appear as pids and threads as tids, and nested events form the
+ * call tree of each thread. Every event carries its flop and byte counts.
+ *
+ * Timestamps count from the barrier in Summary::init, offset by the
+ * difference of MPI_Wtime between processes when MPI_WTIME_IS_GLOBAL is set.
+ * Only the last Constant::kSummaryRingSize events of each thread are kept.
+ *
+ * If merge is set, the events are gathered and written by process 0 to path.
+ * Otherwise every process writes its own path.<rank>, to be merged offline,
+ * e.g. jq -s '{traceEvents: map(.traceEvents) | add}' path.* > path
+ *
+ * Collective over MPI_COMM_WORLD.
+ *
+ * @param path
+ * @param merge
+ */
+void Summary::export_trace(const std::string &path, bool merge) {
+    const int kRank = mpi_rank();
+    // Align the clocks of the processes.
+    int *wtime_global = nullptr;
+    int flag = 0;
+    MPI_Comm_get_attr(MPI_COMM_WORLD, MPI_WTIME_IS_GLOBAL, &wtime_global,
+                      &flag);
+    double wtime_first = summary_wtime_origin_;
+    Communicator<double>::allreduce_inplace(&wtime_first, 1, MPI_MIN);
+    const double kOffset = flag && *wtime_global
+                           ? summary_wtime_origin_ - wtime_first : 0;
+    std::string events;
+    auto add_event = [&events](const std::string &event) {
+        events += events.empty() ? "" : ",\n";
+        events += event;
+    };
+    add_event("{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " +
+              std::to_string(kRank) + ", \"args\": {\"name\": \"rank " +
+              std::to_string(kRank) + "\"}}");
+    {
+        std::lock_guard<std::mutex> lock(summary_mutex_);
+        for (const auto &log: Summary::logs_) {
+            const std::string kIds = "\"pid\": " + std::to_string(kRank) +
+                                     ", \"tid\": " + std::to_string(log->tid);
+            const size_t kSize = log->ring.size();
+            const size_t kDropped =
+                    log->recorded > kSize ? log->recorded - kSize : 0;
+            add_event("{\"name\": \"thread_name\", \"ph\": \"M\", " + kIds +
+                      ", \"args\": {\"name\": \"thread " +
+                      std::to_string(log->tid) + " (" +
+                      std::to_string(kDropped) + " events dropped)\"}}");
+            for (size_t i = kDropped; i < log->recorded; i++) {
+                const Record &record = log->ring[i % kSize];
+                const double kStart =
+                        (kOffset + Summary::seconds(record.tick_start -
+                                                    summary_tick_origin_)) *
+                        1e6;
+                const double kDuration =
+                        Summary::seconds(record.tick_end - record.tick_start) *
+                        1e6;
+                add_event("{\"name\": \"" +
+                          summary_json_escape_(Summary::names_[record.id]) +
+                          "\", \"cat\": \"diana\", \"ph\": \"X\", " + kIds +
+                          ", \"ts\": " + std::to_string(kStart) +
+                          ", \"dur\": " + std::to_string(kDuration) +
+                          ", \"args\": {\"flop\": " +
+                          std::to_string(record.flop) + ", \"bytes\": " +
+                          std::to_string(record.bandwidth) + ", \"depth\": " +
+                          std::to_string(record.depth) + "}}");
+            }
+        }
+    }
+    std::string file = path;
+    if (merge) {
+        const auto kSize = (size_t) mpi_size();
+        std::vector<size_t> counts(kSize);
+        std::vector<size_t> displs(kSize);
+        size_t count = events.size();
+        Communicator<size_t>::allgather(&count, 1, counts.data());
+        size_t total = 0;
+        for (size_t p = 0; p < kSize; p++) {
+            displs[p] = total;
+            total += counts[p];
+        }
+        std::string all(kRank == 0 ? total : 0, ' ');
+        Communicator<char>::gatherv(&events[0], count, &all[0], counts.data(),
+                                    displs.data(), 0);
+        if (kRank == 0) {
+            // Each process contributed a comma-separated list of events.
+            events.clear();
+            for (size_t p = 0; p < kSize; p++) {
+                add_event(all.substr(displs[p], counts[p]));
+            }
+        }
+        if (kRank != 0) {
+            return;
+        }
+    } else {
+        file += "." + std::to_string(kRank);
+    }
+    std::ofstream fout(file);
+    if (!fout) {
+        error("Cannot write trace " + file);
     }
+    fout << "{\"traceEvents\": [\n" << events << "\n]}\n";
 }
 
 void fill_space_(std::string &s, size_t len) {
@@ -97,6 +551,253 @@ void add_separate_line_(std::string &output, int first, int second, int third) {
     output += "\n";
 }
 
+/**
+ * @brief Union of the event names of all processes, sorted.
+ */
+std::vector<std::string> all_names_(const std::vector<std::string> &names) {
+    std::string packed;
+    for (const auto &name: names) {
+        packed += name + '\n';
+    }
+    const auto kSize = (size_t) mpi_size();
+    std::vector<size_t> counts(kSize);
+    std::vector<size_t> displs(kSize);
+    size_t count = packed.size();
+    Communicator<size_t>::allgather(&count, 1, counts.data());
+    size_t total = 0;
+    for (size_t p = 0; p < kSize; p++) {
+        displs[p] = total;
+        total += counts[p];
+    }
+    std::string all(total, ' ');
+    Communicator<char>::allgatherv(packed.data(), count, &all[0],
+                                   counts.data(), displs.data());
+    std::set<std::string> ret;
+    size_t begin = 0;
+    for (size_t end = all.find('\n'); end != std::string::npos;
+         end = all.find('\n', begin)) {
+        ret.insert(all.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return {ret.begin(), ret.end()};
+}
+
+/**
+ * @brief Add the load-balance table: the time of every event over all
+ * processes, its imbalance (maximum over average), the slowest process and
+ * the part of the time spent communicating. local maps the names of the
+ * events of this process to their time and communication time.
+ */
+void add_balance_table_(std::string &output,
+                        const std::map<std::string, std::pair<double, double>> &local,
+                        int first, int caption) {
+    const std::string kSeparate = "| ";
+    std::vector<std::string> names;
+    for (const auto &item: local) {
+        names.push_back(item.first);
+    }
+    names = all_names_(names);
+    const size_t kEvents = names.size();
+    const auto kProcs = (double) mpi_size();
+    std::vector<double> time(kEvents, 0);
+    std::vector<double> sum(2 * kEvents, 0);
+    for (size_t i = 0; i < kEvents; i++) {
+        auto it = local.find(names[i]);
+        if (it != local.end()) {
+            time[i] = it->second.first;
+            sum[2 * i + 1] = it->second.second;
+        }
+        sum[2 * i] = time[i] * time[i];
+    }
+    std::vector<double> time_min(time);
+    Communicator<double>::allreduce_inplace(time_min.data(), kEvents, MPI_MIN);
+    // Sums of the squared times and of the communication times.
+    Communicator<double>::allreduce_inplace(sum.data(), 2 * kEvents, MPI_SUM);
+    struct {
+        double time;
+        int rank;
+    } slowest_local, slowest;
+    slowest_local.rank = mpi_rank();
+    std::vector<double> time_sum(time);
+    Communicator<double>::allreduce_inplace(time_sum.data(), kEvents, MPI_SUM);
+    output += "Load balance over " + std::to_string(mpi_size()) +
+              " processes:\n";
+    add_separate_line_(output, first, 4 * caption, 3 * caption);
+    output += kSeparate;
+    add_data_(output, "", first);
+    output += kSeparate;
+    for (const char *title: {"Min(s)", "Avg(s)", "Max(s)", "Stddev(s)"}) {
+        add_data_(output, title, caption);
+    }
+    output += kSeparate;
+    for (const char *title: {"Max/Avg", "Slowest", "Comm.(%)"}) {
+        add_data_(output, title, caption);
+    }
+    output += kSeparate;
+    output += "\n";
+    add_separate_line_(output, first, 4 * caption, 3 * caption);
+    for (size_t i = 0; i < kEvents; i++) {
+        slowest_local.time = time[i];
+        MPI_Allreduce(&slowest_local, &slowest, 1, MPI_DOUBLE_INT, MPI_MAXLOC,
+                      MPI_COMM_WORLD);
+        const double kAvg = time_sum[i] / kProcs;
+        const double kStddev =
+                std::sqrt(std::max(0.0, sum[2 * i] / kProcs - kAvg * kAvg));
+        output += kSeparate;
+        add_data_(output, names[i], first + 7 * caption + kSeparate.length());
+        output += kSeparate;
+        output += "\n";
+        output += kSeparate;
+        add_data_(output, "", first);
+        output += kSeparate;
+        add_data_(output, std::to_string(time_min[i]), caption);
+        add_data_(output, std::to_string(kAvg), caption);
+        add_data_(output, std::to_string(slowest.time), caption);
+        add_data_(output, std::to_string(kStddev), caption);
+        output += kSeparate;
+        add_data_(output, std::to_string(kAvg == 0 ? 1 : slowest.time / kAvg),
+                  caption);
+        add_data_(output, std::to_string(slowest.rank), caption);
+        add_data_(output, std::to_string(time_sum[i] == 0 ? 0 :
+                                         sum[2 * i + 1] / time_sum[i] * 100),
+                  caption);
+        output += kSeparate;
+        output += "\n";
+        add_separate_line_(output, first, 4 * caption, 3 * caption);
+    }
+}
+
+/**
+ * @brief Add the communication table of this process: for every event its
+ * MPI operations, the average size of the communicators, the payload sent and
+ * received, the achieved network bandwidth over the time the operations were
+ * in flight, and the time of the alpha-beta model with its ratio to that
+ * time. Non-blocking operations are in flight from their start to their
+ * completion, hidden behind computation or not. The flight times of the
+ * operations gathered in an event add up even where they overlap.
+ */
+void add_traffic_table_(
+        std::string &output,
+        const std::map<std::string, Summary::Traffic> &traffics,
+        double latency, double bandwidth, int first, int caption) {
+    const std::string kSeparate = "| ";
+    output += "Communication (process 0), model " +
+              std::to_string(latency * 1e6) + " us + bytes / " +
+              std::to_string(bandwidth / 1073741824) + " GB/s:\n";
+    add_separate_line_(output, first, 4 * caption, 3 * caption);
+    output += kSeparate;
+    add_data_(output, "", first);
+    output += kSeparate;
+    for (const char *title: {"Messages", "Procs", "Sent(MB)", "Recv.(MB)"}) {
+        add_data_(output, title, caption);
+    }
+    output += kSeparate;
+    for (const char *title: {"Netw.(GB/s)", "Model(s)", "Model(%)"}) {
+        add_data_(output, title, caption);
+    }
+    output += kSeparate;
+    output += "\n";
+    add_separate_line_(output, first, 4 * caption, 3 * caption);
+    for (const auto &item: traffics) {
+        const Summary::Traffic &traffic = item.second;
+        const double kTime = Summary::seconds(traffic.tick_flight);
+        const double kModel = latency * (double) traffic.steps +
+                              traffic.model_bytes / bandwidth;
+        output += kSeparate;
+        add_data_(output, item.first, first + 7 * caption + kSeparate.length());
+        output += kSeparate;
+        output += "\n";
+        output += kSeparate;
+        add_data_(output, "", first);
+        output += kSeparate;
+        add_data_(output, std::to_string(traffic.messages), caption);
+        add_data_(output, std::to_string((double) traffic.procs /
+                                         (double) traffic.calls), caption);
+        add_data_(output, std::to_string((double) traffic.sent / 1048576),
+                  caption);
+        add_data_(output, std::to_string((double) traffic.received / 1048576),
+                  caption);
+        output += kSeparate;
+        add_data_(output, std::to_string(
+                kTime == 0 ? 0 : (double) (traffic.sent + traffic.received) /
+                                 1073741824 / kTime), caption);
+        add_data_(output, std::to_string(kModel), caption);
+        add_data_(output, std::to_string(kTime == 0 ? 0 : kModel / kTime * 100),
+                  caption);
+        output += kSeparate;
+        output += "\n";
+        add_separate_line_(output, first, 4 * caption, 3 * caption);
+    }
+}
+
+/**
+ * @brief Add the hardware counter table of this process, a roofline-style
+ * view: for every event its cycles, instructions per cycle, last level cache
+ * misses and floating-point operations, then the arithmetic intensity over
+ * the memory traffic of the misses, that traffic in GB/s, and the flop rate.
+ * rows maps the names of the events to their time, flop estimate and
+ * Summary::Counter values; available tells which counters were read.
+ */
+void add_counters_table_(std::string &output,
+                         const std::map<std::string, std::vector<double>> &rows,
+                         const bool *available, int first, int caption) {
+    const std::string kSeparate = "| ";
+    const double kLineBytes = 64;
+    output += "Hardware counters (process 0), flop from " +
+              std::string(available[Summary::kFPOps]
+                          ? "the PMU" : "the estimates") +
+              ", bytes from last level cache misses:\n";
+    add_separate_line_(output, first, 4 * caption, 3 * caption);
+    output += kSeparate;
+    add_data_(output, "", first);
+    output += kSeparate;
+    for (const char *title: {"Cycles(G)", "IPC", "LLC miss(M)", "FP ops(G)"}) {
+        add_data_(output, title, caption);
+    }
+    output += kSeparate;
+    for (const char *title: {"Flop/Byte", "DRAM(GB/s)", "GFlop/s"}) {
+        add_data_(output, title, caption);
+    }
+    output += kSeparate;
+    output += "\n";
+    add_separate_line_(output, first, 4 * caption, 3 * caption);
+    auto value = [available, caption](std::string &output, int counter,
+                                      double data) {
+        add_data_(output, available[counter] ? std::to_string(data) : "-",
+                  caption);
+    };
+    for (const auto &row: rows) {
+        const double kTime = row.second[0];
+        const double *counters = row.second.data() + 2;
+        const double kFlop = available[Summary::kFPOps]
+                             ? counters[Summary::kFPOps] : row.second[1];
+        const double kBytes = counters[Summary::kCacheMisses] * kLineBytes;
+        output += kSeparate;
+        add_data_(output, row.first, first + 7 * caption + kSeparate.length());
+        output += kSeparate;
+        output += "\n";
+        output += kSeparate;
+        add_data_(output, "", first);
+        output += kSeparate;
+        value(output, Summary::kCycles, counters[Summary::kCycles] / 1e9);
+        value(output, Summary::kInstructions,
+              counters[Summary::kCycles] == 0 ? 0 :
+              counters[Summary::kInstructions] / counters[Summary::kCycles]);
+        value(output, Summary::kCacheMisses,
+              counters[Summary::kCacheMisses] / 1e6);
+        value(output, Summary::kFPOps, counters[Summary::kFPOps] / 1e9);
+        output += kSeparate;
+        value(output, Summary::kCacheMisses, kBytes == 0 ? 0 : kFlop / kBytes);
+        value(output, Summary::kCacheMisses,
+              kTime == 0 ? 0 : kBytes / 1073741824 / kTime);
+        add_data_(output, std::to_string(kTime == 0 ? 0 : kFlop / 1e9 / kTime),
+                  caption);
+        output += kSeparate;
+        output += "\n";
+        add_separate_line_(output, first, 4 * caption, 3 * caption);
+    }
+}
+
 void Summary::print_summary() {
     const int kCaptionLength = 15;
     const int kFirstSectionLength = 10;
@@ -104,11 +805,12 @@ void Summary::print_summary() {
     const std::string kSecondSectionCaption[] = {"Time(s)", "Time C.(%)",
                                                  "Number",
                                                  "Avg. Time(s)"};
-    const std::string kThirdSectionCaption[] = {"GFlop/s", "Bandw.(GB/s)"};
+    const std::string kThirdSectionCaption[] = {"GFlop/s", "Bandw.(GB/s)",
+                                                "Mallocs"};
     std::string output;
     // Display caption row.
     add_separate_line_(output, kFirstSectionLength, 4 * kCaptionLength,
-                       2 * kCaptionLength);
+                       3 * kCaptionLength);
     output += kSeparate;
     add_data_(output, "", kFirstSectionLength);
     output += kSeparate;
@@ -122,24 +824,65 @@ void Summary::print_summary() {
     output += kSeparate;
     output += "\n";
     add_separate_line_(output, kFirstSectionLength, 4 * kCaptionLength,
-                       2 * kCaptionLength);
+                       3 * kCaptionLength);
     // Display events.
-    for (const auto &event_list: Summary::events_name_map_) {
+    // Merge the statistics of all threads, by name.
+    std::map<std::string, Statistics> events;
+    // Communication of every Communicator call site, with its time.
+    std::map<std::string, Traffic> traffics;
+    // Non-blocking communication of every kernel, over all threads.
+    std::map<std::string, Overlap> overlaps;
+    {
+        std::lock_guard<std::mutex> lock(summary_mutex_);
+        for (const auto &log: Summary::logs_) {
+            for (size_t id = 0; id < log->statistics.size(); id++) {
+                const Statistics &item = log->statistics[id];
+                if (item.number == 0) {
+                    continue;
+                }
+                Statistics &total = events[Summary::names_[id]];
+                total.tick_length += item.tick_length;
+                total.tick_counted += item.tick_counted;
+                total.tick_comm += item.tick_comm;
+                total.flop += item.flop;
+                total.bandwidth += item.bandwidth;
+                total.alloc_miss += item.alloc_miss;
+                total.number += item.number;
+                total.kind = item.kind;
+                total.traffic += item.traffic;
+                for (int counter = 0; counter < kCounters; counter++) {
+                    total.counters[counter] += item.counters[counter];
+                }
+            }
+            for (const Edge &edge: log->edges) {
+                if (edge.caller != SIZE_MAX) {
+                    traffics[Summary::names_[edge.callee] + " in " +
+                             Summary::names_[edge.caller]] += edge.traffic;
+                }
+            }
+            for (size_t id = 0; id < log->overlaps.size(); id++) {
+                const Overlap &item = log->overlaps[id];
+                if (item.number == 0) {
+                    continue;
+                }
+                Overlap &total = overlaps[Summary::names_[id]];
+                total.time_comm += item.time_comm;
+                total.time_exposed += item.time_exposed;
+                total.number += item.number;
+            }
+        }
+    }
+    for (const auto &event_list: events) {
         // Get important statistics.
-        double time_length_total = 0;
-        double time_length_counted = 0;
-        long long flop = 0;
-        long long bandwidth = 0;
+        const Statistics &item = event_list.second;
+        double time_length_total = Summary::seconds(item.tick_length);
+        double time_length_counted = Summary::seconds(item.tick_counted);
+        long long flop = item.flop;
+        long long bandwidth = item.bandwidth;
         long long flop_global = 0;
         long long bandwidth_global = 0;
-        size_t number = event_list.second.size();
-        for (const auto &idx: event_list.second) {
-            const auto &event = Summary::events_[idx];
-            time_length_total += event.time_length;
-            time_length_counted += event.time_counted;
-            flop += event.flop;
-            bandwidth += event.bandwidth;
-        }
+        size_t alloc_miss = item.alloc_miss;
+        size_t number = item.number;
         // First section,  and first line, contains name and global data.
         output += kSeparate;
         add_data_(output, event_list.first,
@@ -147,12 +890,10 @@ void Summary::print_summary() {
                   kSeparate.length());
         output += kSeparate;
         if (event_list.first == "{Main}") {
-            (new Communicator<long long>)->allreduce(&flop,
-                                                     &flop_global, 1,
-                                                     MPI_SUM);
-            (new Communicator<long long>)->allreduce(&bandwidth,
-                                                     &bandwidth_global,
-                                                     1, MPI_SUM);
+            Communicator<long long>::allreduce(&flop, &flop_global, 1,
+                                               MPI_SUM);
+            Communicator<long long>::allreduce(&bandwidth, &bandwidth_global,
+                                               1, MPI_SUM);
             add_data_(output,
                       std::to_string((double) flop_global / 1e9 /
                                      time_length_total),
@@ -162,8 +903,13 @@ void Summary::print_summary() {
                               (double) bandwidth_global / 1073741824 /
                               time_length_total),
                       kCaptionLength);
+            size_t alloc_miss_global = 0;
+            Communicator<size_t>::allreduce(&alloc_miss, &alloc_miss_global,
+                                            1, MPI_SUM);
+            add_data_(output, std::to_string(alloc_miss_global),
+                      kCaptionLength);
         } else {
-            add_data_(output, "", 2 * kCaptionLength);
+            add_data_(output, "", 3 * kCaptionLength);
         }
         output += kSeparate;
         output += "\n";
@@ -195,10 +941,75 @@ void Summary::print_summary() {
                   std::to_string(
                           (double) bandwidth / 1073741824 / time_length_total),
                   kCaptionLength);
+        add_data_(output, std::to_string(alloc_miss), kCaptionLength);
         output += kSeparate;
         output += "\n";
         add_separate_line_(output, kFirstSectionLength, 4 * kCaptionLength,
-                           2 * kCaptionLength);
+                           3 * kCaptionLength);
+    }
+    // Display the time of every event over all processes.
+    std::map<std::string, std::pair<double, double>> times;
+    for (const auto &event_list: events) {
+        times[event_list.first] = {
+                Summary::seconds(event_list.second.tick_length),
+                Summary::seconds(event_list.second.tick_comm)};
+    }
+    add_balance_table_(output, times, kFirstSectionLength, kCaptionLength);
+    // Display the communication of this process, per call site of every
+    // Communicator call and gathered for the other events.
+    for (const auto &event_list: events) {
+        const Statistics &item = event_list.second;
+        if (item.kind != kSummaryComm && item.traffic.calls != 0) {
+            traffics[event_list.first] = item.traffic;
+        }
+    }
+    if (!traffics.empty()) {
+        add_traffic_table_(output, traffics, Summary::network_latency_,
+                           Summary::network_bandwidth_, kFirstSectionLength,
+                           kCaptionLength);
+    }
+    // Display the hardware counters of this process.
+    const ThreadLog &log = Summary::log_();
+    if (log.counter_fd[kCycles] >= 0) {
+        bool available[kCounters];
+        std::map<std::string, std::vector<double>> rows;
+        for (int counter = 0; counter < kCounters; counter++) {
+            available[counter] = log.counter_fd[counter] >= 0;
+        }
+        for (const auto &event_list: events) {
+            const Statistics &item = event_list.second;
+            auto &row = rows[event_list.first];
+            row = {Summary::seconds(item.tick_length), (double) item.flop};
+            row.insert(row.end(), item.counters, item.counters + kCounters);
+        }
+        add_counters_table_(output, rows, available, kFirstSectionLength,
+                            kCaptionLength);
+    } else if (Summary::counters_enabled_) {
+        output += "Hardware counters: unavailable (" +
+                  Summary::counters_error_ + ")\n";
+    }
+    // Display allocator statistics, maximum over all processes.
+    auto allocator = Allocator::statistics();
+    size_t allocator_data[] = {allocator.hit, allocator.miss,
+                               allocator.bytes_peak};
+    Communicator<size_t>::allreduce_inplace(allocator_data, 3, MPI_MAX);
+    output += "Allocator: hit = " + std::to_string(allocator_data[0]) +
+              ", miss = " + std::to_string(allocator_data[1]) +
+              ", peak = " +
+              std::to_string((double) allocator_data[2] / 1048576) +
+              " MB (maximum over processes)\n";
+    // Display communication hidden behind computation on this process.
+    for (const auto &overlap: overlaps) {
+        const auto &item = overlap.second;
+        double hidden = item.time_comm - item.time_exposed;
+        output += "Overlap " + overlap.first + ": comm = " +
+                  std::to_string(item.time_comm) + " s, hidden = " +
+                  std::to_string(hidden) + " s (" +
+                  std::to_string(item.time_comm == 0 ? 0 : hidden /
+                                                           item.time_comm *
+                                                           100) +
+                  "%), number = " + std::to_string(item.number) +
+                  " (process 0)\n";
     }
     if (mpi_rank() == 0) {
         std::cerr << output << std::endl;
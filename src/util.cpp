@@ -1,22 +1,41 @@
 #include "util.hpp"
 
-#include <cmath>
+#include <atomic>
 #include <cstring>
 
 void Util::memcpy(void *dst, void *src, size_t len) {
     std::memcpy(dst, src, len);
 }
 
-double Util::randn() {
-    double u = ((double)rand() / (RAND_MAX)) * 2 - 1;
-    double v = ((double)rand() / (RAND_MAX)) * 2 - 1;
-    double r = u * u + v * v;
-    if (r == 0 || r > 1)
-        return Util::randn();
-    double c = sqrt(-2 * log(r) / r);
-    return u * c;
+namespace {
+    uint64_t random_seed_ = Constant::kRandomSeed;
+    // Taken by every random tensor, possibly from several OpenMP threads.
+    std::atomic<uint64_t> random_stream_(0);
+} // namespace
+
+/**
+ * @brief Set the key of the counter-based generator behind Operator::rand and
+ * Operator::randn, and restart its streams, so that the same sequence of
+ * random tensors is generated again.
+ *
+ * @param seed
+ */
+void Util::set_random_seed(uint64_t seed) {
+    random_seed_ = seed;
+    random_stream_ = 0;
 }
 
+uint64_t Util::random_seed() { return random_seed_; }
+
+/**
+ * @brief Index of a fresh stream of the generator. Every random tensor takes
+ * one, so processes have to generate their random tensors in the same order
+ * for the streams to match.
+ *
+ * @return uint64_t
+ */
+uint64_t Util::random_stream() { return random_stream_++; }
+
 size_t Util::calc_size(const shape_t &shape) {
     size_t ret = 1;
     size_t ndim = shape.size();
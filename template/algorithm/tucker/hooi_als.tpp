@@ -62,9 +62,110 @@ namespace Algorithm ::Tucker {
         return q;
     }
 
+    /**
+     * @brief Calculate \f$ \bm{\mathcal{A}} \times_{m} \bm{U}_m^T \f$ for all
+     * m in modes.
+     */
     template<typename Ty>
-    std::tuple<Tensor<Ty>, std::vector<Tensor<Ty>>>
-    HOOI_ALS(const Tensor<Ty> &A, const shape_t &R, size_t max_iter) {
+    Tensor<Ty> HOOI_ttmc_(const Tensor<Ty> &A, const std::vector<Tensor<Ty>> &Ut,
+                          const shape_t &modes) {
+        std::vector<Tensor<Ty>> M;
+        for (size_t m: modes) {
+            M.push_back(Ut[m]);
+        }
+        return Function::ttmc<Ty>(A, M, modes);
+    }
+
+    /**
+     * @brief Bytes of the largest local block of
+     * \f$ \bm{\mathcal{A}} \times_{m} \bm{U}_m^T \f$ for m in modes, the
+     * same on all processes so that they take the same caching decisions.
+     */
+    template<typename Ty>
+    size_t HOOI_node_bytes_(const Tensor<Ty> &A, const shape_t &R,
+                            const shape_t &modes) {
+        auto distrib = (DistributionCartesianBlock *) A.distribution();
+        const shape_t &par = distrib->partition();
+        shape_t shape = A.shape_global();
+        for (size_t m: modes) {
+            shape[m] = R[m];
+        }
+        size_t bytes = sizeof(Ty);
+        for (size_t d = 0; d < shape.size(); d++) {
+            bytes *= DIANA_CEILDIV(shape[d], par[d]);
+        }
+        return bytes;
+    }
+
+    /**
+     * @brief Update U[lo], ..., U[hi - 1] from the node of the dimension tree
+     * holding \f$ \bm{\mathcal{A}} \f$ multiplied by \f$ \bm{U}_m^T \f$ on
+     * every mode m outside [lo, hi). The leaf of the last mode also
+     * forms the core tensor G from the updated factors.
+     *
+     * The node is base multiplied on the modes of pending. A child is only
+     * materialized while the cached nodes fit in budget, otherwise its
+     * modes are passed on and its children start from base again. Factors
+     * of modes outside [lo, hi) do not change while the node is in use, so
+     * the cached nodes stay valid.
+     */
+    template<typename Ty>
+    void HOOI_tree_(const Tensor<Ty> &base, const shape_t &pending, size_t lo,
+                    size_t hi, std::vector<Tensor<Ty>> &U,
+                    std::vector<Tensor<Ty>> &Ut, const shape_t &R,
+                    size_t &budget, Tensor<Ty> &G) {
+        if (hi - lo == 1) {
+            auto Y = HOOI_ttmc_(base, Ut, pending);
+            U[lo] = Algorithm::Tucker::ALS_(Y, lo, U[lo]);
+            Ut[lo] = Function::transpose<Ty>(U[lo]);
+            if (hi == base.ndim()) {
+                G = Function::ttm<Ty>(Y, Ut[lo], lo);
+            }
+            return;
+        }
+        const size_t kMid = (lo + hi) / 2;
+        const size_t kChild[2][2] = {{lo, kMid}, {kMid, hi}};
+        for (const auto &child: kChild) {
+            // Multiply by the modes of this node outside the child.
+            shape_t child_pending(pending);
+            for (size_t m = lo; m < hi; m++) {
+                if (m < child[0] || m >= child[1]) {
+                    child_pending.push_back(m);
+                }
+            }
+            size_t bytes = HOOI_node_bytes_(base, R, child_pending);
+            if (bytes <= budget) {
+                budget -= bytes;
+                auto node = HOOI_ttmc_(base, Ut, child_pending);
+                HOOI_tree_(node, {}, child[0], child[1], U, Ut, R, budget, G);
+                budget += bytes;
+            } else {
+                HOOI_tree_(base, child_pending, child[0], child[1], U, Ut, R,
+                           budget, G);
+            }
+        }
+    }
+
+    /**
+     * @brief Tucker decomposition by HOOI, updating each factor by ALS.
+     *
+     * @tparam Ty
+     * @param A
+     * @param R Tucker ranks.
+     * @param max_iter Maximum number of sweeps.
+     * @param tol Stop once \f$ \|\bm{\mathcal{G}}\|_F \f$ changes by less
+     * than tol * \f$ \|\bm{\mathcal{A}}\|_F \f$ over a sweep.
+     * @param init How the factors are initialized.
+     * @param schedule How the TTM chains of a sweep are formed.
+     * @param memory_budget Bytes per process for the intermediates cached by
+     * TTMcSchedule::kTree, beyond them chains are recomputed.
+     * @return Core tensor, factors and the statistics of every sweep.
+     */
+    template<typename Ty>
+    Result<Ty>
+    HOOI_ALS(const Tensor<Ty> &A, const shape_t &R, size_t max_iter,
+             double tol, Initializer init, TTMcSchedule schedule,
+             size_t memory_budget) {
         assert(R.size() == A.ndim());
         const size_t kN = A.ndim();
         const shape_t &I = A.shape_global();
@@ -72,56 +173,72 @@ namespace Algorithm ::Tucker {
         output("Start Tucker::HOOI_ALS decomposition.. with max_iter = " +
                std::to_string(max_iter));
         // Initialize U.
-        auto distribution = new DistributionGlobal();
         std::vector<Tensor<Ty>> U;
-        for (size_t n = 0; n < kN; n++) {
-            Tensor<double> U_rand(distribution, {I[n], R[n]}, false);
-            U_rand.randn();
-            auto[q, r] = Function::reduced_QR<Ty>(U_rand);
-            U.push_back(q);
+        if (init == Initializer::kSTHOSVD) {
+            U = STHOSVD(A, R).U;
+        } else {
+            auto distribution = new DistributionGlobal();
+            for (size_t n = 0; n < kN; n++) {
+                Tensor<double> U_rand(distribution, {I[n], R[n]}, false);
+                U_rand.randn();
+                auto[q, r] = Function::reduced_QR<Ty>(U_rand);
+                U.push_back(q);
+                U[n].sync(0);
+            }
         }
+        std::vector<Tensor<Ty>> Ut;
         for (size_t n = 0; n < kN; n++) {
-            U[n].sync(0);
+            Ut.push_back(Function::transpose<Ty>(U[n]));
         }
         // Start iteration.
+        Result<Ty> result;
+        result.converged = false;
         auto A_norm = Function::fnorm<Ty>(A);
         output("||A||_F = " + std::to_string(A_norm));
-        size_t k = 0;
         for (size_t iter = 0; iter < max_iter; iter++) {
-            output("Calculating iteration " + std::to_string(iter + 1) +
-                   " ...");
-            // Step ++.
-            k = k + 1;
-            auto Y_pre = A.copy();
-            for (size_t n = 0; n < kN; n++) {
-                // TTMc
-                auto Y = Y_pre.copy();
-                for (size_t i = n + 1; i < kN; i++) {
-                    auto Ut = Function::transpose<Ty>(U[i]);
-                    Y = Function::ttm<Ty>(Y, Ut, i); // TODO: ttmNT
+            double time_start = MPI_Wtime();
+            size_t bytes_start = mpi_bytes_sent();
+            // The core tensor comes out of the last mode of the sweep.
+            if (schedule == TTMcSchedule::kTree) {
+                size_t budget = memory_budget;
+                HOOI_tree_(A, {}, 0, kN, U, Ut, R, budget, result.G);
+            } else {
+                Tensor<Ty> Y_pre = A;
+                for (size_t n = 0; n < kN; n++) {
+                    // TTMc, Y_pre already holds modes 0, ..., n - 1.
+                    shape_t idx;
+                    for (size_t i = n + 1; i < kN; i++) {
+                        idx.push_back(i);
+                    }
+                    auto Y = HOOI_ttmc_(Y_pre, Ut, idx);
+                    // ALS
+                    U[n] = Algorithm::Tucker::ALS_(Y, n, U[n]);
+                    Ut[n] = Function::transpose<Ty>(U[n]);
+                    Y_pre = Function::ttm<Ty>(Y_pre, Ut[n], n); // TODO: ttmNT
                 }
-                // ALS
-                U[n] = Algorithm::Tucker::ALS_(Y, n, U[n]);
-                auto Ut = Function::transpose<Ty>(U[n]);
-                Y_pre = Function::ttm<Ty>(Y_pre, Ut, n); // TODO: ttmNT
+                result.G = Y_pre;
             }
-            auto G = A.copy();
-            for (size_t n = 0; n < kN; n++) {
-                auto Ut = Function::transpose<Ty>(U[n]);
-                G = Function::ttm<Ty>(G, Ut, n);
+            auto G_norm = Function::fnorm<Ty>(result.G);
+            result.iterations.push_back({
+                    G_norm,
+                    sqrt(std::max(1 - (G_norm * G_norm) / (A_norm * A_norm),
+                                  0.0)),
+                    MPI_Wtime() - time_start,
+                    mpi_bytes_sent() - bytes_start
+            });
+            if (iter > 0) {
+                double G_norm_pre = result.iterations[iter - 1].core_norm;
+                if (std::abs(G_norm - G_norm_pre) < tol * A_norm) {
+                    result.converged = true;
+                    break;
+                }
             }
-            auto G_norm = Function::fnorm<Ty>(G);
-            output("||G||_F = " + std::to_string(G_norm));
-            output("Residual: sqrt(1 - ||G||_F^2 / ||A||_F^2) = " +
-                   std::to_string(
-                           sqrt(1 - (G_norm * G_norm) / (A_norm * A_norm))));
         }
-        auto G = A.copy();
-        for (size_t n = 0; n < kN; n++) {
-            auto Ut = Function::transpose<Ty>(U[n]);
-            G = Function::ttm<Ty>(G, Ut, n);
+        if (result.iterations.empty()) {
+            result.G = Function::ttmc<Ty>(A, Ut, kN);
         }
+        result.U = U;
         output("Done!");
-        return std::make_tuple(G, U);
+        return result;
     }
 }
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "tensor.hpp"
+#include "function.hpp"
+#include "logger.hpp"
+#include <algorithm>
+
+namespace Algorithm ::Tucker {
+    /**
+     * @brief Gaussian matrix of shape m * n, identical on all processes.
+     */
+    template<typename Ty>
+    Tensor<Ty> Randomized_gaussian_(size_t m, size_t n) {
+        Tensor<Ty> Omega(new DistributionGlobal(), {m, n}, false);
+        Omega.randn();
+        Omega.sync(0);
+        return Omega;
+    }
+
+    /**
+     * @brief Orthonormal basis Q of shape \f$ I_n \times L \f$ of the range of
+     * \f$ \bm{\mathcal{Y}}_{(n)} \f$, with L at most sketch_size.
+     *
+     * The sketch is \f$ \bm{\mathcal{Y}}_{(n)} (\bm{\Omega}_N \otimes \cdots
+     * \otimes \bm{\Omega}_1) \f$ without the n-th factor, formed by
+     * distributed TTMs with small Gaussian matrices, then reduced to L
+     * columns by one more Gaussian matrix. Each power iteration replaces Q by
+     * an orthonormal basis of \f$ \bm{\mathcal{Y}}_{(n)}
+     * \bm{\mathcal{Y}}_{(n)}^T \bm{Q} \f$, formed by ttm and ttt_except.
+     */
+    template<typename Ty>
+    Tensor<Ty> Randomized_range_(const Tensor<Ty> &Y, size_t n,
+                                 size_t sketch_size, size_t power_iter) {
+        const size_t kN = Y.ndim();
+        const shape_t &D = Y.shape_global();
+        // Grow the Kronecker factors round robin until they hold enough
+        // columns, or the whole of the other modes.
+        shape_t K(kN, 1);
+        size_t columns = 1;
+        for (bool grown = true; grown && columns < sketch_size;) {
+            grown = false;
+            for (size_t d = 0; d < kN && columns < sketch_size; d++) {
+                if (d != n && K[d] < D[d]) {
+                    columns = columns / K[d] * (K[d] + 1);
+                    K[d]++;
+                    grown = true;
+                }
+            }
+        }
+        std::vector<Tensor<Ty>> Omega_t;
+        shape_t idx;
+        for (size_t d = 0; d < kN; d++) {
+            if (d != n) {
+                Omega_t.push_back(Randomized_gaussian_<Ty>(K[d], D[d]));
+                idx.push_back(d);
+            }
+        }
+        auto Z = Function::gather(Function::ttmc<Ty>(Y, Omega_t, idx));
+        Tensor<Ty> Z_n(new DistributionGlobal(), {D[n], columns}, false);
+        Z.op()->tenmat(Z_n.data(), Z.data(), Z.shape(), n);
+        const size_t kL = std::min(columns, sketch_size);
+        if (columns > kL) {
+            Z_n = Function::matmulNN<Ty>(Z_n,
+                                         Randomized_gaussian_<Ty>(columns, kL));
+        }
+        auto[Q, R] = Function::reduced_QR<Ty>(Z_n);
+        for (size_t iter = 0; iter < power_iter; iter++) {
+            auto W = Function::ttm<Ty>(Y, Function::transpose<Ty>(Q), n);
+            auto P = Function::ttt_except<Ty>(Y, W, n);
+            std::tie(Q, R) = Function::reduced_QR<Ty>(P);
+        }
+        Q.sync(0);
+        return Q;
+    }
+
+    /**
+     * @brief Tucker decomposition by randomized sequentially truncated HOSVD.
+     *
+     * For each mode, a randomized range finder gives an orthonormal basis Q
+     * of \f$ R_n \f$ + oversampling columns, the tensor is projected onto Q
+     * and the factor is taken from the small gram matrix of the projection,
+     * so no \f$ I_n \times I_n \f$ gram matrix is formed. Modes whose rank
+     * plus oversampling reaches \f$ I_n \f$ are truncated exactly as in
+     * STHOSVD.
+     *
+     * @tparam Ty
+     * @param A
+     * @param R Tucker ranks.
+     * @param oversampling Extra columns of the sketch.
+     * @param power_iter Number of power iterations.
+     * @return Core tensor, factors and a single iteration entry.
+     */
+    template<typename Ty>
+    Result<Ty> Randomized_STHOSVD(const Tensor<Ty> &A, const shape_t &R,
+                                  size_t oversampling, size_t power_iter) {
+        assert(R.size() == A.ndim());
+        const size_t kN = A.ndim();
+        const shape_t &I = A.shape_global();
+        output("Start Tucker::Randomized_STHOSVD decomposition.. with "
+               "oversampling = " + std::to_string(oversampling) +
+               ", power_iter = " + std::to_string(power_iter));
+        double time_start = MPI_Wtime();
+        size_t bytes_start = mpi_bytes_sent();
+        Result<Ty> result;
+        result.U.resize(kN);
+        Tensor<Ty> Y = A;
+        for (size_t n: STHOSVD_order_(I, R)) {
+            if (R[n] + oversampling >= I[n]) {
+                result.U[n] = STHOSVD_factor_(Y, n, R[n]);
+                Y = Function::ttm<Ty>(Y, Function::transpose<Ty>(result.U[n]),
+                                      n);
+                continue;
+            }
+            auto Q = Randomized_range_(Y, n, R[n] + oversampling, power_iter);
+            auto B = Function::ttm<Ty>(Y, Function::transpose<Ty>(Q), n);
+            auto W = STHOSVD_leading_(Function::gram<Ty>(B, n), R[n]);
+            result.U[n] = Function::matmulNN<Ty>(Q, W);
+            Y = Function::ttm<Ty>(B, Function::transpose<Ty>(W), n);
+        }
+        result.G = Y;
+        auto A_norm = Function::fnorm<Ty>(A);
+        auto G_norm = Function::fnorm<Ty>(result.G);
+        result.iterations.push_back({
+                G_norm,
+                sqrt(std::max(1 - (G_norm * G_norm) / (A_norm * A_norm), 0.0)),
+                MPI_Wtime() - time_start,
+                mpi_bytes_sent() - bytes_start
+        });
+        result.converged = true;
+        output("Done!");
+        return result;
+    }
+}
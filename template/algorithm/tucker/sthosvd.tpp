@@ -0,0 +1,88 @@
+#include "tensor.hpp"
+#include "function.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace Algorithm ::Tucker {
+    /**
+     * @brief Leading r eigenvectors of the symmetric matrix S, largest first.
+     */
+    template<typename Ty>
+    Tensor<Ty> STHOSVD_leading_(const Tensor<Ty> &S, size_t r) {
+        auto[V, w] = Function::eig_sym<Ty>(S);
+        const size_t kI = S.shape()[0];
+        assert(r <= kI);
+        Tensor<Ty> U(new DistributionGlobal(), {kI, r}, false);
+        for (size_t j = 0; j < r; j++) {
+            U.op()->mcpy(U.data() + j * kI, V.data() + (kI - 1 - j) * kI, kI);
+        }
+        // Keep factors bitwise identical on all processes.
+        U.sync(0);
+        return U;
+    }
+
+    /**
+     * @brief Leading r eigenvectors of the gram matrix of
+     * \f$ \bm{\mathcal{Y}} \f$ on mode n, largest first.
+     */
+    template<typename Ty>
+    Tensor<Ty> STHOSVD_factor_(const Tensor<Ty> &Y, size_t n, size_t r) {
+        return STHOSVD_leading_(Function::gram<Ty>(Y, n), r);
+    }
+
+    /**
+     * @brief Modes in decreasing order of \f$ I_n / R_n \f$.
+     */
+    inline shape_t STHOSVD_order_(const shape_t &I, const shape_t &R) {
+        shape_t order(I.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return (double) I[a] / (double) R[a] >
+                   (double) I[b] / (double) R[b];
+        });
+        return order;
+    }
+
+    /**
+     * @brief Tucker decomposition by sequentially truncated HOSVD.
+     *
+     * Modes are truncated in decreasing order of \f$ I_n / R_n \f$, and each
+     * truncation shrinks the tensor before the gram matrix of the next mode
+     * is taken. The factors are the leading eigenvectors of these gram
+     * matrices, computed by a local eigensolver.
+     *
+     * @tparam Ty
+     * @param A
+     * @param R Tucker ranks.
+     * @return Core tensor, factors and a single iteration entry.
+     */
+    template<typename Ty>
+    Result<Ty> STHOSVD(const Tensor<Ty> &A, const shape_t &R) {
+        assert(R.size() == A.ndim());
+        const size_t kN = A.ndim();
+        const shape_t &I = A.shape_global();
+        output("Start Tucker::STHOSVD decomposition..");
+        double time_start = MPI_Wtime();
+        size_t bytes_start = mpi_bytes_sent();
+        Result<Ty> result;
+        result.U.resize(kN);
+        Tensor<Ty> Y = A;
+        for (size_t n: STHOSVD_order_(I, R)) {
+            result.U[n] = STHOSVD_factor_(Y, n, R[n]);
+            Y = Function::ttm<Ty>(Y, Function::transpose<Ty>(result.U[n]), n);
+        }
+        result.G = Y;
+        auto A_norm = Function::fnorm<Ty>(A);
+        auto G_norm = Function::fnorm<Ty>(result.G);
+        result.iterations.push_back({
+                G_norm,
+                sqrt(std::max(1 - (G_norm * G_norm) / (A_norm * A_norm), 0.0)),
+                MPI_Wtime() - time_start,
+                mpi_bytes_sent() - bytes_start
+        });
+        result.converged = true;
+        output("Done!");
+        return result;
+    }
+}
@@ -1,6 +1,7 @@
 #include "def.hpp"
 #include "logger.hpp"
 #include "summary.hpp"
+#include <algorithm>
 #include <cstdint>
 #include <climits>
 
@@ -16,6 +17,307 @@
 #define MPI_SIZE_T MPI_UNSIGNED_LONG_LONG
 #endif
 
+inline int communicator_rank_(MPI_Comm comm) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    return rank;
+}
+
+inline int communicator_size_(MPI_Comm comm) {
+    int size;
+    MPI_Comm_size(comm, &size);
+    return size;
+}
+
+inline size_t communicator_sum_counts_(const size_t *counts, MPI_Comm comm) {
+    size_t sum = 0;
+    for (int i = 0; i < communicator_size_(comm); i++) {
+        sum += counts[i];
+    }
+    return sum;
+}
+
+/**
+ * Convert counts and displacements of every process of comm to int, as MPI
+ * takes them. Return false, leaving the output unspecified, if any of them
+ * exceeds mpi_max_count().
+ */
+inline bool
+communicator_int_counts_(const size_t *counts, const size_t *displs,
+                         MPI_Comm comm, std::vector<int> &int_counts,
+                         std::vector<int> &int_displs) {
+    const int kSize = communicator_size_(comm);
+    int_counts.resize((size_t) kSize);
+    int_displs.resize((size_t) kSize);
+    size_t displ = 0;
+    for (int i = 0; i < kSize; i++) {
+        if (displs != nullptr) {
+            displ = displs[i];
+        }
+        if (counts[i] > mpi_max_count() || displ > mpi_max_count()) {
+            return false;
+        }
+        int_counts[(size_t) i] = (int) counts[i];
+        int_displs[(size_t) i] = (int) displ;
+        displ += counts[i];
+    }
+    return true;
+}
+
+/**
+ * @brief count consecutive elements of type, passed to MPI as a single
+ * element of a derived datatype if count exceeds mpi_max_count().
+ *
+ * The datatype is freed on destruction, which is safe as soon as the
+ * operation using it has been posted.
+ */
+class CommunicatorCount_ {
+public:
+    MPI_Datatype type;
+    int count;
+
+    CommunicatorCount_(size_t count, MPI_Datatype type) {
+        const size_t kMax = mpi_max_count();
+        if (count <= kMax) {
+            this->type = type;
+            this->count = (int) count;
+            return;
+        }
+        // count / kMax full blocks, then the remainder.
+        const size_t kBlocks = count / kMax;
+        const size_t kRemain = count % kMax;
+        MPI_Datatype blocks;
+        MPI_Type_vector((int) kBlocks, (int) kMax, (int) kMax, type, &blocks);
+        if (kRemain == 0) {
+            this->type = blocks;
+        } else {
+            MPI_Aint lb, extent;
+            MPI_Type_get_extent(type, &lb, &extent);
+            MPI_Datatype remain;
+            MPI_Type_contiguous((int) kRemain, type, &remain);
+            int lengths[] = {1, 1};
+            MPI_Aint displs[] = {0, (MPI_Aint) (kBlocks * kMax) * extent};
+            MPI_Datatype types[] = {blocks, remain};
+            MPI_Type_create_struct(2, lengths, displs, types, &this->type);
+            MPI_Type_free(&blocks);
+            MPI_Type_free(&remain);
+        }
+        MPI_Type_commit(&this->type);
+        this->count = 1;
+        this->derived_ = true;
+    }
+
+    CommunicatorCount_(const CommunicatorCount_ &) = delete;
+
+    CommunicatorCount_ &operator=(const CommunicatorCount_ &) = delete;
+
+    ~CommunicatorCount_() {
+        if (this->derived_) {
+            MPI_Type_free(&this->type);
+        }
+    }
+
+private:
+    bool derived_ = false;
+};
+
+inline void communicator_start_(std::vector<MPI_Request> &requests) {
+    MPI_Startall((int) requests.size(), requests.data());
+}
+
+/**
+ * Number of MPI calls moving counts[i] elements for every process of comm,
+ * at most mpi_max_count() each.
+ */
+inline size_t communicator_messages_(const size_t *counts, MPI_Comm comm) {
+    size_t ret = 0;
+    for (int i = 0; i < communicator_size_(comm); i++) {
+        ret += DIANA_CEILDIV(counts[i], mpi_max_count());
+    }
+    return ret;
+}
+
+/**
+ * Communication of a collective over comm. In the alpha-beta model it takes
+ * ceil(log2(p)) latencies, and model_bytes on the critical path, for which
+ * the bandwidth-optimal algorithms move (p - 1) / p of the data per step of
+ * a reduce-scatter or allgather phase, see communicator_share_.
+ */
+inline Summary::Traffic
+communicator_collective_(size_t sent, size_t received, size_t messages,
+                         double model_bytes, MPI_Comm comm) {
+    const int kSize = communicator_size_(comm);
+    long long steps = 0;
+    while ((1LL << steps) < kSize) {
+        steps++;
+    }
+    return {(long long) sent, (long long) received, (long long) messages, 1,
+            kSize, steps, model_bytes, 0};
+}
+
+/** Part (p - 1) / p of bytes, which leaves every process of comm. */
+inline double communicator_share_(size_t bytes, MPI_Comm comm) {
+    const auto kSize = (double) communicator_size_(comm);
+    return (double) bytes * (kSize - 1) / kSize;
+}
+
+/**
+ * Communication of a point-to-point exchange, one latency and the larger
+ * direction in the alpha-beta model.
+ */
+inline Summary::Traffic
+communicator_p2p_(size_t sent, size_t received, size_t messages,
+                  MPI_Comm comm) {
+    return {(long long) sent, (long long) received, (long long) messages, 1,
+            communicator_size_(comm), 1,
+            (double) std::max(sent, received), 0};
+}
+
+/**
+ * Account the communication of a blocking call to mpi_bytes_sent and to the
+ * innermost Summary event.
+ */
+inline void communicator_account_(const Summary::Traffic &traffic) {
+    mpi_add_bytes_sent((size_t) traffic.sent);
+    Summary::traffic(traffic);
+}
+
+template<class Ty>
+Summary::Traffic
+communicator_allreduce_traffic_(size_t size, MPI_Comm comm) {
+    const size_t kBytes = size * sizeof(Ty);
+    return communicator_collective_(kBytes, kBytes,
+                                    std::max<size_t>(1, DIANA_CEILDIV(
+                                            size, mpi_max_count())),
+                                    2 * communicator_share_(kBytes, comm),
+                                    comm);
+}
+
+template<class Ty>
+Summary::Traffic
+communicator_reduce_scatter_traffic_(const size_t *recvcounts,
+                                     MPI_Comm comm) {
+    const size_t kTotal = communicator_sum_counts_(recvcounts, comm);
+    return communicator_collective_(
+            kTotal * sizeof(Ty),
+            recvcounts[communicator_rank_(comm)] * sizeof(Ty),
+            kTotal <= mpi_max_count()
+            ? 1 : communicator_messages_(recvcounts, comm),
+            communicator_share_(kTotal * sizeof(Ty), comm), comm);
+}
+
+template<class Ty>
+Summary::Traffic
+communicator_allgatherv_traffic_(size_t sendcount, const size_t *recvcounts,
+                                 bool fit, MPI_Comm comm) {
+    const size_t kTotal = communicator_sum_counts_(recvcounts, comm);
+    return communicator_collective_(
+            sendcount * sizeof(Ty), kTotal * sizeof(Ty),
+            fit ? 1 : (size_t) communicator_size_(comm),
+            communicator_share_(kTotal * sizeof(Ty), comm), comm);
+}
+
+/**
+ * Post the allreduce of size elements as calls of at most mpi_max_count()
+ * elements, appending their requests.
+ */
+template<class Ty>
+std::function<void(std::vector<MPI_Request> &)>
+communicator_iallreduce_(const Ty *sendbuf, Ty *recvbuf, size_t size,
+                         MPI_Op op, MPI_Comm comm) {
+    return [=](std::vector<MPI_Request> &requests) {
+        const MPI_Datatype kType = Communicator<Ty>::mpi_type();
+        for (size_t offset = 0; offset < size; offset += mpi_max_count()) {
+            MPI_Request request;
+            MPI_Iallreduce(sendbuf + offset, recvbuf + offset,
+                           (int) std::min(mpi_max_count(), size - offset),
+                           kType, op, comm, &request);
+            requests.push_back(request);
+        }
+    };
+}
+
+/**
+ * Post a reduce-scatter. Beyond mpi_max_count() elements, it becomes one
+ * reduction per block, each split into calls of at most mpi_max_count().
+ */
+template<class Ty>
+std::function<void(std::vector<MPI_Request> &)>
+communicator_ireduce_scatter_(const Ty *sendbuf, Ty *recvbuf,
+                              const size_t *recvcounts, MPI_Op op,
+                              MPI_Comm comm) {
+    std::vector<int> counts, displs;
+    if (communicator_int_counts_(recvcounts, nullptr, comm, counts, displs) &&
+        communicator_sum_counts_(recvcounts, comm) <= mpi_max_count()) {
+        return [=](std::vector<MPI_Request> &requests) {
+            MPI_Request request;
+            MPI_Ireduce_scatter(sendbuf, recvbuf, counts.data(),
+                                Communicator<Ty>::mpi_type(), op, comm,
+                                &request);
+            requests.push_back(request);
+        };
+    }
+    std::vector<size_t> block_counts(recvcounts, recvcounts +
+                                                 communicator_size_(comm));
+    const int kRank = communicator_rank_(comm);
+    return [=](std::vector<MPI_Request> &requests) {
+        size_t displ = 0;
+        for (size_t i = 0; i < block_counts.size(); i++) {
+            for (size_t offset = 0; offset < block_counts[i];
+                 offset += mpi_max_count()) {
+                MPI_Request request;
+                MPI_Ireduce(sendbuf + displ + offset,
+                            (int) i == kRank ? recvbuf + offset : nullptr,
+                            (int) std::min(mpi_max_count(),
+                                           block_counts[i] - offset),
+                            Communicator<Ty>::mpi_type(), op, (int) i, comm,
+                            &request);
+                requests.push_back(request);
+            }
+            displ += block_counts[i];
+        }
+    };
+}
+
+/**
+ * Post an allgatherv. Beyond mpi_max_count() elements, it becomes one
+ * broadcast per block, each block a single derived datatype.
+ */
+template<class Ty>
+std::function<void(std::vector<MPI_Request> &)>
+communicator_iallgatherv_(const Ty *sendbuf, size_t sendcount, Ty *recvbuf,
+                          const size_t *recvcounts, const size_t *displs,
+                          MPI_Comm comm) {
+    std::vector<int> counts, int_displs;
+    if (communicator_int_counts_(recvcounts, displs, comm, counts,
+                                 int_displs)) {
+        return [=](std::vector<MPI_Request> &requests) {
+            MPI_Request request;
+            MPI_Iallgatherv(sendbuf, (int) sendcount,
+                            Communicator<Ty>::mpi_type(), recvbuf,
+                            counts.data(), int_displs.data(),
+                            Communicator<Ty>::mpi_type(), comm, &request);
+            requests.push_back(request);
+        };
+    }
+    const int kSize = communicator_size_(comm);
+    std::vector<size_t> block_counts(recvcounts, recvcounts + kSize);
+    std::vector<size_t> block_displs(displs, displs + kSize);
+    const int kRank = communicator_rank_(comm);
+    return [=](std::vector<MPI_Request> &requests) {
+        std::copy(sendbuf, sendbuf + sendcount,
+                  recvbuf + block_displs[(size_t) kRank]);
+        for (size_t i = 0; i < block_counts.size(); i++) {
+            CommunicatorCount_ count(block_counts[i],
+                                     Communicator<Ty>::mpi_type());
+            MPI_Request request;
+            MPI_Ibcast(recvbuf + block_displs[i], count.count, count.type,
+                       (int) i, comm, &request);
+            requests.push_back(request);
+        }
+    };
+}
+
 template<class Ty>
 Communicator<Ty>::Communicator() {
     MPI_Comm_size(MPI_COMM_WORLD, &this->size_);
@@ -25,6 +327,20 @@ Communicator<Ty>::Communicator() {
 template<class Ty>
 Communicator<Ty>::~Communicator() = default;
 
+/**
+ * @brief Get the process-wide communicator of MPI_COMM_WORLD.
+ *
+ * Rank and size are queried once, on the first call after MPI_Init.
+ *
+ * @tparam Ty
+ * @return Communicator<Ty>*
+ */
+template<class Ty>
+Communicator<Ty> *Communicator<Ty>::instance() {
+    static Communicator<Ty> communicator;
+    return &communicator;
+}
+
 template<class Ty>
 int Communicator<Ty>::size() const { return this->size_; }
 
@@ -41,6 +357,8 @@ constexpr MPI_Datatype Communicator<Ty>::mpi_type() {
         return MPI_C_COMPLEX;
     } else if constexpr (std::is_same<Ty, complex64>::value) {
         return MPI_C_DOUBLE_COMPLEX;
+    } else if constexpr (std::is_same<Ty, char>::value) {
+        return MPI_CHAR;
     } else if constexpr (std::is_same<Ty, int>::value) {
         return MPI_INT;
     } else if constexpr (std::is_same<Ty, long long>::value) {
@@ -64,133 +382,701 @@ void Communicator<Ty>::free_request(MPI_Request *request) {
 
 template<class Ty>
 MPI_Comm Communicator<Ty>::comm_split(int color, int rank, MPI_Comm comm) {
-    Summary::start(METHOD_NAME);
+    Summary::start(DIANA_EVENT_ID);
     MPI_Comm ret;
     MPI_Comm_split(comm, color, rank, &ret);
-    Summary::end(METHOD_NAME);
+    Summary::end(DIANA_EVENT_ID);
     return ret;
 }
 
+/**
+ * @brief Create a non-periodic Cartesian topology over comm without
+ * reordering, so ranks in the new communicator equal ranks in comm.
+ *
+ * @tparam Ty
+ * @param ndim
+ * @param dims
+ * @param comm
+ * @return MPI_Comm
+ */
 template<class Ty>
-void Communicator<Ty>::bcast(Ty *A, int size, int proc, MPI_Comm comm) {
-    Summary::start(METHOD_NAME);
-    MPI_Bcast(A, size, mpi_type(), proc, comm);
-    Summary::end(METHOD_NAME);
+MPI_Comm Communicator<Ty>::cart_create(int ndim, const int *dims,
+                                       MPI_Comm comm) {
+    Summary::start(DIANA_EVENT_ID);
+    MPI_Comm ret;
+    std::vector<int> periods(ndim, 0);
+    MPI_Cart_create(comm, ndim, dims, periods.data(), 0, &ret);
+    Summary::end(DIANA_EVENT_ID);
+    return ret;
 }
 
+/**
+ * @brief Partition a Cartesian communicator into the sub-grids spanned by
+ * the dimensions where remain_dims is non-zero.
+ *
+ * @tparam Ty
+ * @param comm
+ * @param remain_dims
+ * @return MPI_Comm
+ */
+template<class Ty>
+MPI_Comm Communicator<Ty>::cart_sub(MPI_Comm comm, const int *remain_dims) {
+    Summary::start(DIANA_EVENT_ID);
+    MPI_Comm ret;
+    MPI_Cart_sub(comm, remain_dims, &ret);
+    Summary::end(DIANA_EVENT_ID);
+    return ret;
+}
+
+/**
+ * @brief Free comm unless it is null or MPI is already finalized.
+ *
+ * @tparam Ty
+ * @param comm
+ */
+template<class Ty>
+void Communicator<Ty>::comm_free(MPI_Comm *comm) {
+    int finalized;
+    MPI_Finalized(&finalized);
+    if (!finalized && *comm != MPI_COMM_NULL) {
+        MPI_Comm_free(comm);
+    }
+}
+
+
 template<class Ty>
-void Communicator<Ty>::allreduce_inplace(Ty *A, int size, MPI_Op op,
+void Communicator<Ty>::bcast(Ty *A, size_t size, int proc, MPI_Comm comm) {
+    Summary::start(DIANA_EVENT_ID);
+    const size_t kBytes = size * sizeof(Ty);
+    const bool kRoot = communicator_rank_(comm) == proc;
+    communicator_account_(communicator_collective_(
+            kRoot ? kBytes : 0, kRoot ? 0 : kBytes, 1,
+            2 * communicator_share_(kBytes, comm), comm));
+    CommunicatorCount_ count(size, mpi_type());
+    MPI_Bcast(A, count.count, count.type, proc, comm);
+    Summary::end(DIANA_EVENT_ID);
+}
+
+template<class Ty>
+void Communicator<Ty>::allreduce_inplace(Ty *A, size_t size, MPI_Op op,
                                          MPI_Comm comm) {
-    Summary::start(METHOD_NAME);
-    MPI_Allreduce(MPI_IN_PLACE, A, size, mpi_type(), op, comm);
-    Summary::end(METHOD_NAME);
+    Summary::start(DIANA_EVENT_ID);
+    communicator_account_(communicator_allreduce_traffic_<Ty>(size, comm));
+    // Predefined reductions do not apply to derived datatypes, so split.
+    for (size_t offset = 0; offset < size; offset += mpi_max_count()) {
+        MPI_Allreduce(MPI_IN_PLACE, A + offset,
+                      (int) std::min(mpi_max_count(), size - offset),
+                      mpi_type(), op, comm);
+    }
+    Summary::end(DIANA_EVENT_ID);
 }
 
 template<class Ty>
-void Communicator<Ty>::allreduce(Ty *sendbuf, Ty *recvbuf, int size, MPI_Op op,
-                                 MPI_Comm comm) {
-    Summary::start(METHOD_NAME);
-    MPI_Allreduce(sendbuf, recvbuf, size, mpi_type(), op, comm);
-    Summary::end(METHOD_NAME);
+void Communicator<Ty>::allreduce(Ty *sendbuf, Ty *recvbuf, size_t size,
+                                 MPI_Op op, MPI_Comm comm) {
+    Summary::start(DIANA_EVENT_ID);
+    communicator_account_(communicator_allreduce_traffic_<Ty>(size, comm));
+    for (size_t offset = 0; offset < size; offset += mpi_max_count()) {
+        MPI_Allreduce(sendbuf + offset, recvbuf + offset,
+                      (int) std::min(mpi_max_count(), size - offset),
+                      mpi_type(), op, comm);
+    }
+    Summary::end(DIANA_EVENT_ID);
 }
 
 template<class Ty>
-void Communicator<Ty>::sendrecv(Ty *A, int size, int des, MPI_Comm comm) {
-    Summary::start(METHOD_NAME);
-    MPI_Status status;
-    MPI_Sendrecv_replace(A, size, mpi_type(), des, 0, des, 0, comm,
-                         &status);
-    Summary::end(METHOD_NAME);
+void Communicator<Ty>::sendrecv(Ty *A, size_t size, int des, MPI_Comm comm) {
+    Summary::start(DIANA_EVENT_ID);
+    communicator_account_(communicator_p2p_(size * sizeof(Ty),
+                                            size * sizeof(Ty), 1, comm));
+    CommunicatorCount_ count(size, mpi_type());
+    MPI_Sendrecv_replace(A, count.count, count.type, des, 0, des, 0, comm,
+                         MPI_STATUS_IGNORE);
+    Summary::end(DIANA_EVENT_ID);
 }
 
 template<class Ty>
 void
-Communicator<Ty>::sendrecv(Ty *sendbuf, int sendcount, int dest, Ty *recvbuf,
-                           int recvcount, int source, MPI_Comm comm) {
-    Summary::start(METHOD_NAME);
-    MPI_Status status;
-    MPI_Sendrecv(sendbuf, sendcount, mpi_type(), dest, 0, recvbuf,
-                 recvcount, mpi_type(), source, 0, comm, &status);
-    Summary::end(METHOD_NAME);
+Communicator<Ty>::sendrecv(Ty *sendbuf, size_t sendcount, int dest,
+                           Ty *recvbuf, size_t recvcount, int source,
+                           MPI_Comm comm) {
+    Summary::start(DIANA_EVENT_ID);
+    communicator_account_(communicator_p2p_(sendcount * sizeof(Ty),
+                                            recvcount * sizeof(Ty), 1, comm));
+    CommunicatorCount_ send(sendcount, mpi_type());
+    CommunicatorCount_ recv(recvcount, mpi_type());
+    MPI_Sendrecv(sendbuf, send.count, send.type, dest, 0, recvbuf,
+                 recv.count, recv.type, source, 0, comm, MPI_STATUS_IGNORE);
+    Summary::end(DIANA_EVENT_ID);
 }
 
 template<class Ty>
 void Communicator<Ty>::reduce_scatter(Ty *sendbuf, Ty *recvbuf,
-                                      const int *recvcounts, MPI_Op op,
+                                      const size_t *recvcounts, MPI_Op op,
                                       MPI_Comm comm) {
-    Summary::start(METHOD_NAME);
-    MPI_Reduce_scatter(sendbuf, recvbuf, recvcounts, mpi_type(), op,
-                       comm);
-    Summary::end(METHOD_NAME);
+    Summary::start(DIANA_EVENT_ID);
+    const size_t kTotal = communicator_sum_counts_(recvcounts, comm);
+    communicator_account_(
+            communicator_reduce_scatter_traffic_<Ty>(recvcounts, comm));
+    std::vector<int> counts, displs;
+    if (kTotal <= mpi_max_count()) {
+        communicator_int_counts_(recvcounts, nullptr, comm, counts, displs);
+        MPI_Reduce_scatter(sendbuf, recvbuf, counts.data(), mpi_type(), op,
+                           comm);
+    } else {
+        // One reduction per block, split into calls of mpi_max_count().
+        const int kRank = communicator_rank_(comm);
+        size_t displ = 0;
+        for (int i = 0; i < communicator_size_(comm); i++) {
+            for (size_t offset = 0; offset < recvcounts[i];
+                 offset += mpi_max_count()) {
+                MPI_Reduce(sendbuf + displ + offset,
+                           i == kRank ? recvbuf + offset : nullptr,
+                           (int) std::min(mpi_max_count(),
+                                          recvcounts[i] - offset),
+                           mpi_type(), op, i, comm);
+            }
+            displ += recvcounts[i];
+        }
+    }
+    Summary::end(DIANA_EVENT_ID);
+}
+
+/**
+ * @brief Start a non-blocking allreduce.
+ *
+ * @tparam Ty
+ * @param sendbuf
+ * @param recvbuf
+ * @param size
+ * @param op
+ * @param comm
+ * @return Request in flight.
+ */
+template<class Ty>
+Request Communicator<Ty>::iallreduce(const Ty *sendbuf, Ty *recvbuf,
+                                     size_t size, MPI_Op op, MPI_Comm comm) {
+    Request request(DIANA_EVENT_ID,
+                    communicator_allreduce_traffic_<Ty>(size, comm),
+                    communicator_iallreduce_(sendbuf, recvbuf, size, op,
+                                             comm), false);
+    request.start();
+    return request;
+}
+
+/**
+ * @brief Start a non-blocking reduce-scatter.
+ *
+ * @tparam Ty
+ * @param sendbuf
+ * @param recvbuf
+ * @param recvcounts
+ * @param op
+ * @param comm
+ * @return Request in flight.
+ */
+template<class Ty>
+Request Communicator<Ty>::ireduce_scatter(const Ty *sendbuf, Ty *recvbuf,
+                                          const size_t *recvcounts, MPI_Op op,
+                                          MPI_Comm comm) {
+    Request request(DIANA_EVENT_ID,
+                    communicator_reduce_scatter_traffic_<Ty>(recvcounts, comm),
+                    communicator_ireduce_scatter_(sendbuf, recvbuf,
+                                                  recvcounts, op, comm),
+                    false);
+    request.start();
+    return request;
+}
+
+/**
+ * @brief Start a non-blocking allgatherv.
+ *
+ * @tparam Ty
+ * @param sendbuf
+ * @param sendcount
+ * @param recvbuf
+ * @param recvcounts
+ * @param displs
+ * @param comm
+ * @return Request in flight.
+ */
+template<class Ty>
+Request Communicator<Ty>::iallgatherv(const Ty *sendbuf, size_t sendcount,
+                                      Ty *recvbuf, const size_t *recvcounts,
+                                      const size_t *displs, MPI_Comm comm) {
+    std::vector<int> counts, int_displs;
+    const bool kFit = communicator_int_counts_(recvcounts, displs, comm,
+                                               counts, int_displs);
+    Request request(DIANA_EVENT_ID,
+                    communicator_allgatherv_traffic_<Ty>(sendcount,
+                                                         recvcounts, kFit,
+                                                         comm),
+                    communicator_iallgatherv_(sendbuf, sendcount, recvbuf,
+                                              recvcounts, displs, comm),
+                    false);
+    request.start();
+    return request;
+}
+
+/**
+ * @brief Create a persistent send of buf, posted by every Request::start.
+ *
+ * @tparam Ty
+ * @param buf
+ * @param count
+ * @param dest
+ * @param comm
+ * @param tag
+ * @return Request, not started.
+ */
+template<class Ty>
+Request Communicator<Ty>::send_init(const Ty *buf, size_t count, int dest,
+                                    MPI_Comm comm, int tag) {
+    MPI_Request req;
+    CommunicatorCount_ send(count, mpi_type());
+    MPI_Send_init(buf, send.count, send.type, dest, tag, comm, &req);
+    return {DIANA_EVENT_ID,
+            communicator_p2p_(count * sizeof(Ty), 0, 1, comm),
+            communicator_start_, true, {req}};
+}
+
+/**
+ * @brief Create a persistent receive into buf, posted by every
+ * Request::start.
+ *
+ * @tparam Ty
+ * @param buf
+ * @param count
+ * @param source
+ * @param comm
+ * @param tag
+ * @return Request, not started.
+ */
+template<class Ty>
+Request Communicator<Ty>::recv_init(Ty *buf, size_t count, int source,
+                                    MPI_Comm comm, int tag) {
+    MPI_Request req;
+    CommunicatorCount_ recv(count, mpi_type());
+    MPI_Recv_init(buf, recv.count, recv.type, source, tag, comm, &req);
+    return {DIANA_EVENT_ID,
+            communicator_p2p_(0, count * sizeof(Ty), 1, comm),
+            communicator_start_, true, {req}};
+}
+
+/**
+ * @brief Create a persistent allreduce, posted by every Request::start.
+ *
+ * With MPI-4 this is MPI_Allreduce_init, so the setup is done once;
+ * otherwise, or beyond mpi_max_count() elements, every start posts the
+ * non-blocking allreduce again.
+ *
+ * @tparam Ty
+ * @param sendbuf
+ * @param recvbuf
+ * @param size
+ * @param op
+ * @param comm
+ * @return Request, not started.
+ */
+template<class Ty>
+Request Communicator<Ty>::allreduce_init(const Ty *sendbuf, Ty *recvbuf,
+                                         size_t size, MPI_Op op,
+                                         MPI_Comm comm) {
+    const Summary::Traffic kTraffic =
+            communicator_allreduce_traffic_<Ty>(size, comm);
+#if MPI_VERSION >= 4
+    if (size <= mpi_max_count()) {
+        MPI_Request req;
+        MPI_Allreduce_init(sendbuf, recvbuf, (int) size, mpi_type(), op, comm,
+                           MPI_INFO_NULL, &req);
+        return {DIANA_EVENT_ID, kTraffic, communicator_start_, true, {req}};
+    }
+#endif
+    return {DIANA_EVENT_ID, kTraffic,
+            communicator_iallreduce_(sendbuf, recvbuf, size, op, comm), true};
+}
+
+/**
+ * @brief Create a persistent reduce-scatter, posted by every Request::start.
+ *
+ * @tparam Ty
+ * @param sendbuf
+ * @param recvbuf
+ * @param recvcounts
+ * @param op
+ * @param comm
+ * @return Request, not started.
+ */
+template<class Ty>
+Request
+Communicator<Ty>::reduce_scatter_init(const Ty *sendbuf, Ty *recvbuf,
+                                      const size_t *recvcounts, MPI_Op op,
+                                      MPI_Comm comm) {
+    const Summary::Traffic kTraffic =
+            communicator_reduce_scatter_traffic_<Ty>(recvcounts, comm);
+#if MPI_VERSION >= 4
+    const size_t kTotal = communicator_sum_counts_(recvcounts, comm);
+    std::vector<int> counts, displs;
+    if (kTotal <= mpi_max_count()) {
+        communicator_int_counts_(recvcounts, nullptr, comm, counts, displs);
+        MPI_Request req;
+        MPI_Reduce_scatter_init(sendbuf, recvbuf, counts.data(), mpi_type(),
+                                op, comm, MPI_INFO_NULL, &req);
+        return {DIANA_EVENT_ID, kTraffic,
+                [counts](std::vector<MPI_Request> &requests) {
+                    communicator_start_(requests);
+                }, true, {req}};
+    }
+#endif
+    return {DIANA_EVENT_ID, kTraffic,
+            communicator_ireduce_scatter_(sendbuf, recvbuf, recvcounts, op,
+                                          comm), true};
+}
+
+/**
+ * @brief Create a persistent allgatherv, posted by every Request::start.
+ *
+ * @tparam Ty
+ * @param sendbuf
+ * @param sendcount
+ * @param recvbuf
+ * @param recvcounts
+ * @param displs
+ * @param comm
+ * @return Request, not started.
+ */
+template<class Ty>
+Request
+Communicator<Ty>::allgatherv_init(const Ty *sendbuf, size_t sendcount,
+                                  Ty *recvbuf, const size_t *recvcounts,
+                                  const size_t *displs, MPI_Comm comm) {
+    std::vector<int> counts, int_displs;
+    const bool kFit = communicator_int_counts_(recvcounts, displs, comm,
+                                               counts, int_displs);
+    const Summary::Traffic kTraffic =
+            communicator_allgatherv_traffic_<Ty>(sendcount, recvcounts, kFit,
+                                                 comm);
+#if MPI_VERSION >= 4
+    if (kFit) {
+        MPI_Request req;
+        MPI_Allgatherv_init(sendbuf, (int) sendcount, mpi_type(), recvbuf,
+                            counts.data(), int_displs.data(), mpi_type(),
+                            comm, MPI_INFO_NULL, &req);
+        return {DIANA_EVENT_ID, kTraffic,
+                [counts, int_displs](std::vector<MPI_Request> &requests) {
+                    communicator_start_(requests);
+                }, true, {req}};
+    }
+#endif
+    return {DIANA_EVENT_ID, kTraffic,
+            communicator_iallgatherv_(sendbuf, sendcount, recvbuf,
+                                      recvcounts, displs, comm), true};
 }
 
 template<class Ty>
 void
-Communicator<Ty>::allgather(const Ty *sendbuf, int sendcount, Ty *recvbuf,
+Communicator<Ty>::allgather(const Ty *sendbuf, size_t sendcount, Ty *recvbuf,
                             MPI_Comm comm) {
-    Summary::start(METHOD_NAME);
-    MPI_Allgather(sendbuf, sendcount, mpi_type(), recvbuf,
-                  sendcount, mpi_type(), comm);
-    Summary::end(METHOD_NAME);
+    Summary::start(DIANA_EVENT_ID);
+    const int kSize = communicator_size_(comm);
+    const size_t kTotal = sendcount * (size_t) kSize;
+    communicator_account_(communicator_collective_(
+            sendcount * sizeof(Ty), kTotal * sizeof(Ty),
+            kTotal <= mpi_max_count() ? 1 : (size_t) kSize,
+            communicator_share_(kTotal * sizeof(Ty), comm), comm));
+    if (kTotal <= mpi_max_count()) {
+        MPI_Allgather(sendbuf, (int) sendcount, mpi_type(), recvbuf,
+                      (int) sendcount, mpi_type(), comm);
+    } else {
+        // One broadcast per block.
+        const int kRank = communicator_rank_(comm);
+        std::copy(sendbuf, sendbuf + sendcount,
+                  recvbuf + (size_t) kRank * sendcount);
+        CommunicatorCount_ count(sendcount, mpi_type());
+        for (int i = 0; i < kSize; i++) {
+            MPI_Bcast(recvbuf + (size_t) i * sendcount, count.count,
+                      count.type, i, comm);
+        }
+    }
+    Summary::end(DIANA_EVENT_ID);
 }
 
 template<class Ty>
 void
-Communicator<Ty>::allgatherv(const Ty *sendbuf, int sendcount, Ty *recvbuf,
-                             const int *recvcounts, const int *displs,
+Communicator<Ty>::allgatherv(const Ty *sendbuf, size_t sendcount, Ty *recvbuf,
+                             const size_t *recvcounts, const size_t *displs,
                              MPI_Comm comm) {
-    Summary::start(METHOD_NAME);
-    MPI_Allgatherv(sendbuf, sendcount, mpi_type(), recvbuf, recvcounts, displs,
-                   mpi_type(), comm);
-    Summary::end(METHOD_NAME);
+    Summary::start(DIANA_EVENT_ID);
+    std::vector<int> counts, int_displs;
+    const bool kFit = communicator_int_counts_(recvcounts, displs, comm,
+                                               counts, int_displs);
+    communicator_account_(communicator_allgatherv_traffic_<Ty>(
+            sendcount, recvcounts, kFit, comm));
+    if (kFit) {
+        MPI_Allgatherv(sendbuf, (int) sendcount, mpi_type(), recvbuf,
+                       counts.data(), int_displs.data(), mpi_type(), comm);
+    } else {
+        // One broadcast per block.
+        std::copy(sendbuf, sendbuf + sendcount,
+                  recvbuf + displs[communicator_rank_(comm)]);
+        for (int i = 0; i < communicator_size_(comm); i++) {
+            CommunicatorCount_ count(recvcounts[i], mpi_type());
+            MPI_Bcast(recvbuf + displs[i], count.count, count.type, i, comm);
+        }
+    }
+    Summary::end(DIANA_EVENT_ID);
 }
 
+/**
+ * @brief Gather blocks of varying counts on root. recvcounts and displs are
+ * only significant on root, which tells the other processes whether they fit
+ * a single MPI_Gatherv; otherwise every block is sent point-to-point.
+ *
+ * @tparam Ty
+ * @param sendbuf
+ * @param sendcount
+ * @param recvbuf
+ * @param recvcounts
+ * @param displs
+ * @param root
+ * @param comm
+ */
 template<class Ty>
-void Communicator<Ty>::gatherv(Ty *sendbuf, int sendcount, Ty *recvbuf,
-                               const int *recvcounts, const int *displs,
+void Communicator<Ty>::gatherv(Ty *sendbuf, size_t sendcount, Ty *recvbuf,
+                               const size_t *recvcounts, const size_t *displs,
                                int root, MPI_Comm comm) {
-    Summary::start(METHOD_NAME);
-    MPI_Gatherv(sendbuf, sendcount, mpi_type(), recvbuf, recvcounts,
-                displs, mpi_type(), root, comm);
-    Summary::end(METHOD_NAME);
+    Summary::start(DIANA_EVENT_ID);
+    const int kRank = communicator_rank_(comm);
+    std::vector<int> counts, int_displs;
+    int fit = kRank != root ||
+              communicator_int_counts_(recvcounts, displs, comm, counts,
+                                       int_displs);
+    MPI_Bcast(&fit, 1, MPI_INT, root, comm);
+    // Only root knows the total, which it receives on the critical path.
+    const size_t kBytes = kRank == root
+                          ? communicator_sum_counts_(recvcounts, comm) *
+                            sizeof(Ty) : 0;
+    communicator_account_(communicator_collective_(
+            sendcount * sizeof(Ty), kBytes,
+            fit ? 2 : kRank == root ? (size_t) communicator_size_(comm) : 2,
+            kRank == root ? communicator_share_(kBytes, comm)
+                          : (double) (sendcount * sizeof(Ty)), comm));
+    if (fit) {
+        MPI_Gatherv(sendbuf, (int) sendcount, mpi_type(), recvbuf,
+                    counts.data(), int_displs.data(), mpi_type(), root, comm);
+    } else if (kRank == root) {
+        const int kSize = communicator_size_(comm);
+        std::vector<MPI_Request> requests;
+        for (int i = 0; i < kSize; i++) {
+            if (i != root) {
+                CommunicatorCount_ count(recvcounts[i], mpi_type());
+                requests.emplace_back();
+                MPI_Irecv(recvbuf + displs[i], count.count, count.type, i, 0,
+                          comm, &requests.back());
+            }
+        }
+        std::copy(sendbuf, sendbuf + sendcount, recvbuf + displs[root]);
+        MPI_Waitall((int) requests.size(), requests.data(),
+                    MPI_STATUSES_IGNORE);
+    } else {
+        CommunicatorCount_ count(sendcount, mpi_type());
+        MPI_Send(sendbuf, count.count, count.type, root, 0, comm);
+    }
+    Summary::end(DIANA_EVENT_ID);
 }
 
+/**
+ * @brief Scatter blocks of varying counts from root. sendcounts and displs
+ * are only significant on root, as for gatherv.
+ *
+ * @tparam Ty
+ * @param sendbuf
+ * @param sendcounts
+ * @param displs
+ * @param recvbuf
+ * @param recvcount
+ * @param root
+ * @param comm
+ */
 template<class Ty>
-void Communicator<Ty>::scatterv(Ty *sendbuf, const int *sendcounts,
-                                const int *displs, Ty *recvbuf, int recvcount,
-                                int root, MPI_Comm comm) {
-    Summary::start(METHOD_NAME);
-    MPI_Scatterv(sendbuf, sendcounts, displs, mpi_type(), recvbuf,
-                 recvcount, mpi_type(), root, comm);
-    Summary::end(METHOD_NAME);
+void Communicator<Ty>::scatterv(Ty *sendbuf, const size_t *sendcounts,
+                                const size_t *displs, Ty *recvbuf,
+                                size_t recvcount, int root, MPI_Comm comm) {
+    Summary::start(DIANA_EVENT_ID);
+    const int kRank = communicator_rank_(comm);
+    std::vector<int> counts, int_displs;
+    int fit = 1;
+    if (kRank == root) {
+        fit = communicator_int_counts_(sendcounts, displs, comm, counts,
+                                       int_displs);
+    }
+    MPI_Bcast(&fit, 1, MPI_INT, root, comm);
+    // Only root knows the total, which it sends on the critical path.
+    const size_t kBytes = kRank == root
+                          ? communicator_sum_counts_(sendcounts, comm) *
+                            sizeof(Ty) : 0;
+    communicator_account_(communicator_collective_(
+            kBytes, recvcount * sizeof(Ty),
+            fit ? 2 : kRank == root ? (size_t) communicator_size_(comm) : 2,
+            kRank == root ? communicator_share_(kBytes, comm)
+                          : (double) (recvcount * sizeof(Ty)), comm));
+    if (fit) {
+        MPI_Scatterv(sendbuf, counts.data(), int_displs.data(), mpi_type(),
+                     recvbuf, (int) recvcount, mpi_type(), root, comm);
+    } else if (kRank == root) {
+        const int kSize = communicator_size_(comm);
+        std::vector<MPI_Request> requests;
+        for (int i = 0; i < kSize; i++) {
+            if (i != root) {
+                CommunicatorCount_ count(sendcounts[i], mpi_type());
+                requests.emplace_back();
+                MPI_Isend(sendbuf + displs[i], count.count, count.type, i, 0,
+                          comm, &requests.back());
+            }
+        }
+        std::copy(sendbuf + displs[root], sendbuf + displs[root] + recvcount,
+                  recvbuf);
+        MPI_Waitall((int) requests.size(), requests.data(),
+                    MPI_STATUSES_IGNORE);
+    } else {
+        CommunicatorCount_ count(recvcount, mpi_type());
+        MPI_Recv(recvbuf, count.count, count.type, root, 0, comm,
+                 MPI_STATUS_IGNORE);
+    }
+    Summary::end(DIANA_EVENT_ID);
+}
+
+/**
+ * @brief Datatype of the block of shape block_shape starting at block_start
+ * in a column major tensor of shape shape. Every extent of block_shape must
+ * be positive, and every extent of shape at most INT_MAX, which
+ * MPI_Type_create_subarray takes; free the result with free_type.
+ *
+ * @tparam Ty
+ * @param shape
+ * @param block_shape
+ * @param block_start
+ * @return MPI_Datatype
+ */
+template<class Ty>
+MPI_Datatype
+Communicator<Ty>::block_type(const std::vector<size_t> &shape,
+                             const std::vector<size_t> &block_shape,
+                             const std::vector<size_t> &block_start) {
+    for (size_t extent: shape) {
+        if (extent > (size_t) INT_MAX) {
+            fatal("Communicator::block_type: extent " +
+                  std::to_string(extent) + " exceeds INT_MAX.");
+        }
+    }
+    std::vector<int> sizes(shape.begin(), shape.end());
+    std::vector<int> subsizes(block_shape.begin(), block_shape.end());
+    std::vector<int> starts(block_start.begin(), block_start.end());
+    MPI_Datatype type;
+    MPI_Type_create_subarray((int) shape.size(), sizes.data(),
+                             subsizes.data(), starts.data(), MPI_ORDER_FORTRAN,
+                             mpi_type(), &type);
+    MPI_Type_commit(&type);
+    return type;
+}
+
+template<class Ty>
+void Communicator<Ty>::free_type(MPI_Datatype *type) {
+    MPI_Type_free(type);
+}
+
+/**
+ * @brief Exchange with every process of comm one element of a per-process
+ * datatype, which lets blocks land in place in a larger tensor. Entries with
+ * zero count are ignored.
+ *
+ * @tparam Ty
+ * @param sendbuf
+ * @param sendcounts
+ * @param sendtypes
+ * @param recvbuf
+ * @param recvcounts
+ * @param recvtypes
+ * @param comm
+ */
+template<class Ty>
+void Communicator<Ty>::alltoallw(const Ty *sendbuf, const int *sendcounts,
+                                 const MPI_Datatype *sendtypes, Ty *recvbuf,
+                                 const int *recvcounts,
+                                 const MPI_Datatype *recvtypes,
+                                 MPI_Comm comm) {
+    Summary::start(DIANA_EVENT_ID);
+    const int kSize = communicator_size_(comm);
+    const int kRank = communicator_rank_(comm);
+    size_t sent = 0;
+    size_t received = 0;
+    long long peers = 0;
+    for (int i = 0; i < kSize; i++) {
+        MPI_Count type_size;
+        if (sendcounts[i] != 0 && i != kRank) {
+            MPI_Type_size_x(sendtypes[i], &type_size);
+            sent += (size_t) sendcounts[i] * (size_t) type_size;
+            peers++;
+        }
+        if (recvcounts[i] != 0 && i != kRank) {
+            MPI_Type_size_x(recvtypes[i], &type_size);
+            received += (size_t) recvcounts[i] * (size_t) type_size;
+        }
+    }
+    // A pairwise exchange, one latency per peer.
+    communicator_account_({(long long) sent, (long long) received, 1, 1,
+                           kSize, peers, (double) std::max(sent, received),
+                           0});
+    std::vector<int> displs((size_t) kSize, 0);
+    MPI_Alltoallw(sendbuf, sendcounts, displs.data(), sendtypes, recvbuf,
+                  recvcounts, displs.data(), recvtypes, comm);
+    Summary::end(DIANA_EVENT_ID);
 }
 
 template<class Ty>
 void Communicator<Ty>::barrier(MPI_Comm comm) {
-    Summary::start(METHOD_NAME);
+    Summary::start(DIANA_EVENT_ID);
+    communicator_account_(communicator_collective_(0, 0, 1, 0, comm));
     MPI_Barrier(comm);
-    Summary::end(METHOD_NAME);
+    Summary::end(DIANA_EVENT_ID);
 }
 
 template<class Ty>
 void Communicator<Ty>::wait(MPI_Request *request) {
-    Summary::start(METHOD_NAME);
+    Summary::start(DIANA_EVENT_ID);
     MPI_Status status;
     MPI_Wait(request, &status);
-    Summary::end(METHOD_NAME);
+    Summary::end(DIANA_EVENT_ID);
+}
+
+/**
+ * @brief Check whether request has completed, driving the progress of MPI.
+ *
+ * @tparam Ty
+ * @param request
+ * @return true if request has completed.
+ */
+template<class Ty>
+bool Communicator<Ty>::test(MPI_Request *request) {
+    int flag;
+    MPI_Test(request, &flag, MPI_STATUS_IGNORE);
+    return flag != 0;
 }
 
 template<class Ty>
 void
-Communicator<Ty>::isend(MPI_Request *request, Ty *buf, int count, int dest,
+Communicator<Ty>::isend(MPI_Request *request, Ty *buf, size_t count, int dest,
                         MPI_Comm comm, int tag) {
-    MPI_Isend(buf, count, mpi_type(), dest, tag, comm, request);
+    communicator_account_(communicator_p2p_(count * sizeof(Ty), 0, 1, comm));
+    CommunicatorCount_ send(count, mpi_type());
+    MPI_Isend(buf, send.count, send.type, dest, tag, comm, request);
 }
 
 template<class Ty>
 void
-Communicator<Ty>::irecv(MPI_Request *request, Ty *buf, int count, int source,
-                        MPI_Comm comm,
-                        int tag) {
-    MPI_Irecv(buf, count, mpi_type(), source, tag, comm, request);
-}
\ No newline at end of file
+Communicator<Ty>::irecv(MPI_Request *request, Ty *buf, size_t count,
+                        int source, MPI_Comm comm, int tag) {
+    communicator_account_(communicator_p2p_(0, count * sizeof(Ty), 1, comm));
+    CommunicatorCount_ recv(count, mpi_type());
+    MPI_Irecv(buf, recv.count, recv.type, source, tag, comm, request);
+}
@@ -7,7 +7,7 @@ namespace Function {
     Tensor<Ty> matmulNN(const Tensor<Ty> &A, const Tensor<Ty> &B) {
         if (A.distribution() == nullptr ||
             A.distribution()->type() == Distribution::Type::kGlobal) {
-            Summary::start(METHOD_NAME);
+            Summary::start(DIANA_EVENT_ID);
             assert(A.is_matrix());
             assert(A.shape()[1] == B.shape()[0]);
             size_t m = A.shape()[0];
@@ -15,7 +15,7 @@ namespace Function {
             size_t k = A.shape()[1];
             Tensor<Ty> ret({m, n}, false);
             A.op()->matmulNN(ret.data(), A.data(), B.data(), m, n, k);
-            Summary::end(METHOD_NAME);
+            Summary::end(DIANA_EVENT_ID);
             return ret;
         }
         error("Invalid input or not implemented yet.");
@@ -25,7 +25,7 @@ namespace Function {
     Tensor<Ty> matmulNT(const Tensor<Ty> &A, const Tensor<Ty> &B) {
         if (A.distribution() == nullptr ||
             A.distribution()->type() == Distribution::Type::kGlobal) {
-            Summary::start(METHOD_NAME);
+            Summary::start(DIANA_EVENT_ID);
             assert(A.is_matrix());
             assert(A.shape()[1] == B.shape()[1]);
             size_t m = A.shape()[0];
@@ -33,7 +33,7 @@ namespace Function {
             size_t k = A.shape()[1];
             Tensor<Ty> ret({m, n}, false);
             A.op()->matmulNT(ret.data(), A.data(), B.data(), m, n, k);
-            Summary::end(METHOD_NAME);
+            Summary::end(DIANA_EVENT_ID);
             return ret;
         }
         error("Invalid input or not implemented yet.");
@@ -44,7 +44,7 @@ namespace Function {
     Tensor<Ty> matmulTN(const Tensor<Ty> &A, const Tensor<Ty> &B) {
         if (A.distribution() == nullptr ||
             A.distribution()->type() == Distribution::Type::kGlobal) {
-            Summary::start(METHOD_NAME);
+            Summary::start(DIANA_EVENT_ID);
             assert(A.is_matrix());
             assert(A.shape()[0] == B.shape()[0]);
             size_t m = A.shape()[1];
@@ -52,7 +52,7 @@ namespace Function {
             size_t k = A.shape()[0];
             Tensor<Ty> ret({m, n}, false);
             A.op()->matmulTN(ret.data(), A.data(), B.data(), m, n, k);
-            Summary::end(METHOD_NAME);
+            Summary::end(DIANA_EVENT_ID);
             return ret;
         }
         error("Invalid input or not implemented yet.");
@@ -62,12 +62,12 @@ namespace Function {
     Tensor<Ty> inverse(const Tensor<Ty> &A) {
         if (A.distribution() == nullptr ||
             A.distribution()->type() == Distribution::Type::kGlobal) {
-            Summary::start(METHOD_NAME);
+            Summary::start(DIANA_EVENT_ID);
             assert(A.is_matrix());
             assert(A.shape()[0] == A.shape()[1]);
             Tensor<Ty> ret(A.shape(), true);
             A.op()->inverse(ret.data(), A.data(), A.shape()[0]);
-            Summary::end(METHOD_NAME);
+            Summary::end(DIANA_EVENT_ID);
             return ret;
         }
         error("Invalid input or not implemented yet.");
@@ -77,7 +77,7 @@ namespace Function {
     std::tuple<Tensor<Ty>, Tensor<Ty>> reduced_LQ(const Tensor<Ty> &A) {
         if (A.distribution() == nullptr ||
             A.distribution()->type() == Distribution::Type::kGlobal) {
-            Summary::start(METHOD_NAME);
+            Summary::start(DIANA_EVENT_ID);
             assert(A.is_matrix());
             assert(A.shape()[0] <= A.shape()[1]);
             size_t m = A.shape()[0];
@@ -86,7 +86,7 @@ namespace Function {
             Tensor<Ty> Q({m, n}, true);
             A.op()->LQ(L.data(), Q.data(), A.data(), A.shape()[0],
                        A.shape()[1]);
-            Summary::end(METHOD_NAME);
+            Summary::end(DIANA_EVENT_ID);
             return std::make_tuple(L, Q);
         }
         error("Invalid input or not implemented yet.");
@@ -96,7 +96,7 @@ namespace Function {
     std::tuple<Tensor<Ty>, Tensor<Ty>> reduced_QR(const Tensor<Ty> &A) {
         if (A.distribution() == nullptr ||
             A.distribution()->type() == Distribution::Type::kGlobal) {
-            Summary::start(METHOD_NAME);
+            Summary::start(DIANA_EVENT_ID);
             assert(A.is_matrix());
             assert(A.shape()[0] >= A.shape()[1]);
             size_t m = A.shape()[0];
@@ -105,23 +105,48 @@ namespace Function {
             Tensor<Ty> R({n, n}, true);
             A.op()->QR(Q.data(), R.data(), A.data(), A.shape()[0],
                        A.shape()[1]);
-            Summary::end(METHOD_NAME);
+            Summary::end(DIANA_EVENT_ID);
             return std::make_tuple(Q, R);
         }
         error("Invalid input or not implemented yet.");
     }
 
+    /**
+     * @brief Eigendecomposition \f$ \bm{A} = \bm{V} diag(\bm{w}) \bm{V}^T
+     * \f$ of a symmetric matrix, eigenvalues in ascending order.
+     *
+     * @tparam Ty
+     * @param A
+     * @return Eigenvectors V and eigenvalues w.
+     */
+    template<typename Ty>
+    std::tuple<Tensor<Ty>, Tensor<Ty>> eig_sym(const Tensor<Ty> &A) {
+        if (A.distribution() == nullptr ||
+            A.distribution()->type() == Distribution::Type::kGlobal) {
+            Summary::start(DIANA_EVENT_ID);
+            assert(A.is_matrix());
+            assert(A.shape()[0] == A.shape()[1]);
+            size_t n = A.shape()[0];
+            Tensor<Ty> V({n, n}, false);
+            Tensor<Ty> w({n}, false);
+            A.op()->eig_sym(V.data(), w.data(), A.data(), n);
+            Summary::end(DIANA_EVENT_ID);
+            return std::make_tuple(V, w);
+        }
+        error("Invalid input or not implemented yet.");
+    }
+
     template<typename Ty>
     Tensor<Ty> transpose(const Tensor<Ty> &A) {
         if (A.distribution() == nullptr ||
             A.distribution()->type() == Distribution::Type::kGlobal) {
-            Summary::start(METHOD_NAME);
+            Summary::start(DIANA_EVENT_ID);
             assert(A.is_matrix());
             size_t m = A.shape()[0];
             size_t n = A.shape()[1];
             Tensor<Ty> At({n, m}, false);
             A.op()->transpose(At.data(), A.data(), m, n);
-            Summary::end(METHOD_NAME);
+            Summary::end(DIANA_EVENT_ID);
             return At;
         }
         error("Invalid input or not implemented yet.");
@@ -132,7 +157,7 @@ namespace Function {
     Tensor<Ty> gram(const Tensor<Ty> &A) {
         if (A.distribution() == nullptr ||
             A.distribution()->type() == Distribution::Type::kGlobal) {
-            Summary::start(METHOD_NAME);
+            Summary::start(DIANA_EVENT_ID);
             assert(A.is_matrix());
             size_t M = A.shape()[0];
             size_t N = A.shape()[1];
@@ -6,9 +6,59 @@
 #include <algorithm>
 
 namespace Function {
+    /**
+     * @brief Assemble the column major matrix C from the row blocks held by
+     * the processes of comm, with a single allgatherv and a local reorder.
+     *
+     * @tparam Ty
+     * @param C Result of shape \f$ \sum_p rows_p \times cols \f$
+     * @param buf Local row block of shape \f$ rows_{rank} \times cols \f$
+     * @param rows Number of rows of each process.
+     * @param par Number of processes of comm.
+     * @param rank Rank of this process in comm.
+     * @param cols
+     * @param comm
+     */
+    template<typename Ty>
+    void allgather_rows_(Ty *C, Ty *buf, const size_t *rows, size_t par,
+                         size_t rank, size_t cols, MPI_Comm comm) {
+        size_t *recvcounts = Operator<size_t>::alloc(par);
+        size_t *displs = Operator<size_t>::alloc(par);
+        size_t total_rows = 0;
+        for (size_t p = 0; p < par; p++) {
+            recvcounts[p] = rows[p] * cols;
+            displs[p] = total_rows * cols;
+            total_rows += rows[p];
+        }
+        Ty *recv_buf = Operator<Ty>::alloc(total_rows * cols);
+        Communicator<Ty>::allgatherv(buf, recvcounts[rank], recv_buf,
+                                     recvcounts, displs, comm);
+        // Block p holds rows [row_begin, row_begin + rows[p]) of C.
+        size_t row_begin = 0;
+        for (size_t p = 0; p < par; p++) {
+            for (size_t j = 0; j < cols; j++) {
+                Operator<Ty>::mcpy(C + row_begin + j * total_rows,
+                                   recv_buf + displs[p] + j * rows[p],
+                                   rows[p]);
+            }
+            row_begin += rows[p];
+        }
+        Operator<Ty>::free(recv_buf);
+        Operator<size_t>::free(recvcounts);
+        Operator<size_t>::free(displs);
+    }
+
     /**
      * @brief Calculate \f$ \bm{\mathcal{A}}_{(n)} \bm{\mathcal{A}}_{(n)}^T \f$,
      * where \f$ \bm{\mathcal{A}} \f$ is a tensor.
+     *
+     * Process p of the mode-n fiber holds row block p of the unfolding. As
+     * the result is symmetric, it computes the upper triangle of its diagonal
+     * block by SYRK and the blocks (p, p + k) for k up to about P / 2, which
+     * covers every off-diagonal block once. The row blocks travel half of the
+     * ring, and only these packed blocks are reduced over the slice and
+     * gathered over the fiber.
+     *
      * @tparam Ty
      * @param A
      * @param n
@@ -17,102 +67,151 @@ namespace Function {
     template<typename Ty>
     Tensor<Ty> gram(const Tensor<Ty> &A, size_t n) {
         if (A.distribution()->type() == Distribution::Type::kCartesianBlock) {
-            Summary::start(METHOD_NAME);
+            Summary::start(DIANA_EVENT_ID);
             // Initialization.
             auto *distrib = (DistributionCartesianBlock *) A.distribution();
-            shape_t par = distrib->partition();
-            shape_t coord = distrib->coordinate();
-            const size_t kParN = par[n];
+            const size_t kParN = distrib->partition()[n];
             const size_t kGlobalShapeN = A.shape_global()[n];
             const size_t kLocalShapeN = A.shape()[n];
             // Split communicator.
             auto[new_color, new_rank] = distrib->process_fiber(n);
             MPI_Comm comm_fiber = distrib->process_fiber_comm(n);
-            // Allocate double buffer.
-            size_t max_size = A.size();
-            Ty *data_A = A.data();
-            Ty *databuf[2]; // Double buffer
-            Communicator<size_t>::allreduce_inplace(&max_size, 1,
-                                                    MPI_MAX, comm_fiber);
-            databuf[0] = A.op()->alloc(max_size);
-            databuf[1] = A.op()->alloc(max_size);
-            // Allocate gram_buffer.
+            const auto kRank = (size_t) new_rank;
+            // Row blocks of every process of the fiber.
             const size_t row_length = kLocalShapeN;
             const size_t col_length = A.size() / kLocalShapeN;
             size_t *all_row_length = Operator<size_t>::alloc(kParN);
-            size_t *gram_buf_start = Operator<size_t>::alloc(kParN);
-            size_t gram_buf_size;
-            auto gram_buf_point = (size_t) new_rank;
-            Communicator<size_t>::allgather(&row_length, 1, all_row_length,
-                                            comm_fiber);
-            gram_buf_start[0] = 0;
-            for (size_t i = 1; i < kParN; i++) {
-                gram_buf_start[i] =
-                        gram_buf_start[i - 1] + all_row_length[i - 1];
+            size_t *row_start = Operator<size_t>::alloc(kParN);
+            for (size_t p = 0; p < kParN; p++) {
+                row_start[p] = DIANA_CEILDIV(kGlobalShapeN * p, kParN);
+                all_row_length[p] =
+                        DIANA_CEILDIV(kGlobalShapeN * (p + 1), kParN) -
+                        row_start[p];
             }
-            gram_buf_size = row_length * kGlobalShapeN;
-            Ty *gram_buf = A.op()->alloc(gram_buf_size);
-            // Allocate A_buf.
+            // Process p computes blocks (p, p + k) for 0 < k <= kSteps[p].
+            const size_t kMaxSteps = kParN / 2;
+            auto steps = [&](size_t p) {
+                return (kParN - 1) / 2 + (kParN % 2 == 0 && p < kMaxSteps);
+            };
+            auto packed_size = [&](size_t p) {
+                size_t size = all_row_length[p] * (all_row_length[p] + 1) / 2;
+                for (size_t k = 1; k <= steps(p); k++) {
+                    size += all_row_length[p] *
+                            all_row_length[(p + k) % kParN];
+                }
+                return size;
+            };
+            // Allocate double buffer.
+            size_t max_size = DIANA_CEILDIV(kGlobalShapeN, kParN) * col_length;
+            Ty *databuf[2]; // Double buffer
+            databuf[0] = A.op()->alloc(max_size);
+            databuf[1] = A.op()->alloc(max_size);
             Ty *A_buf = A.op()->alloc(A.size());
-            // Initialize data transpose.
+            Ty *diag_buf = A.op()->alloc(row_length * row_length);
+            Ty *packed_buf = A.op()->alloc(packed_size(kRank));
             const int send_to_proc_id =
                     ((int) new_rank - 1 + (int) kParN) % (int) kParN;
             const int recv_from_proc_id = ((int) new_rank + 1) % (int) kParN;
             // Matricization
-            A.op()->tenmat(A_buf, data_A, A.shape(), n);
+            A.op()->tenmat(A_buf, A.data(), A.shape(), n);
             A.op()->mcpy(databuf[0], A_buf, A.size());
-            // Do gram
-            MPI_Request *request_send = A.comm()->new_request();
-            MPI_Request *request_recv = A.comm()->new_request();
-            for (size_t i = 0; i < kParN; i++) {
+            // Do gram over half of the ring.
+            // Persistent requests of the ring, one pair per buffer.
+            Request request_send[2] = {
+                    A.comm()->send_init(databuf[0], max_size,
+                                        send_to_proc_id, comm_fiber),
+                    A.comm()->send_init(databuf[1], max_size,
+                                        send_to_proc_id, comm_fiber)};
+            Request request_recv[2] = {
+                    A.comm()->recv_init(databuf[1], max_size,
+                                        recv_from_proc_id, comm_fiber),
+                    A.comm()->recv_init(databuf[0], max_size,
+                                        recv_from_proc_id, comm_fiber)};
+            size_t offset = row_length * (row_length + 1) / 2;
+            for (size_t i = 0; i <= kMaxSteps; i++) {
                 if (i != 0) {
-                    A.comm()->wait(request_send);
-                    A.comm()->wait(request_recv);
+                    request_send[(i - 1) % 2].wait();
+                    request_recv[(i - 1) % 2].wait();
                 }
-                if (i != kParN - 1) {
-                    A.comm()->isend(request_send, databuf[i % 2],
-                                    (int) max_size,
-                                    send_to_proc_id, comm_fiber);
-                    A.comm()->irecv(request_recv,
-                                    databuf[(i + 1) % 2],
-                                    (int) max_size,
-                                    recv_from_proc_id, comm_fiber);
+                if (i != kMaxSteps) {
+                    request_send[i % 2].start();
+                    request_recv[i % 2].start();
+                }
+                if (i == 0) {
+                    A.op()->syrk(diag_buf, A_buf, row_length, col_length);
+                    // Pack the upper triangle column by column.
+                    size_t pos = 0;
+                    for (size_t j = 0; j < row_length; j++) {
+                        A.op()->mcpy(packed_buf + pos,
+                                     diag_buf + j * row_length, j + 1);
+                        pos += j + 1;
+                    }
+                } else if (i <= steps(kRank)) {
+                    size_t q = (kRank + i) % kParN;
+                    A.op()->matmulNT(packed_buf + offset, A_buf,
+                                     databuf[i % 2], row_length,
+                                     all_row_length[q], col_length);
+                    offset += row_length * all_row_length[q];
                 }
-                A.op()->matmulNT(gram_buf +
-                                 gram_buf_start[gram_buf_point] * kLocalShapeN,
-                                 A_buf, databuf[i % 2], row_length,
-                                 all_row_length[gram_buf_point], col_length);
-                gram_buf_point = (gram_buf_point + 1) % kParN;
             }
             // Allreduce.
-            MPI_Comm comm_line = A.comm()->comm_split(new_rank, new_color);
-            A.comm()->allreduce_inplace(gram_buf, (int) gram_buf_size, MPI_SUM,
-                                        comm_line);
+            MPI_Comm comm_line = distrib->process_slice_comm(n);
+            A.comm()->allreduce_inplace(packed_buf, packed_size(kRank),
+                                        MPI_SUM, comm_line);
             // Gather.
+            size_t *recvcounts = Operator<size_t>::alloc(kParN);
+            size_t *displs = Operator<size_t>::alloc(kParN);
+            size_t total_size = 0;
+            for (size_t p = 0; p < kParN; p++) {
+                recvcounts[p] = packed_size(p);
+                displs[p] = total_size;
+                total_size += packed_size(p);
+            }
+            Ty *recv_buf = A.op()->alloc(total_size);
+            A.comm()->allgatherv(packed_buf, recvcounts[kRank], recv_buf,
+                                 recvcounts, displs, comm_fiber);
+            // Unpack, mirroring every block.
             Tensor<Ty> gram({kGlobalShapeN, kGlobalShapeN}, false);
             Ty *gram_data = gram.data();
-            int *recvcount = Operator<int>::alloc(kParN);
-            int *displs = Operator<int>::alloc(kParN);
-            for (size_t i = 0; i < kParN; i++) {
-                recvcount[i] = (int) all_row_length[i];
-                displs[i] = (int) gram_buf_start[i];
-            }
-            for (size_t i = 0; i < kGlobalShapeN; i++) {
-                A.comm()->allgatherv(gram_buf + i * kLocalShapeN,
-                                     (int) kLocalShapeN,
-                                     gram_data + i * kGlobalShapeN,
-                                     recvcount, displs, comm_fiber);
+            for (size_t p = 0; p < kParN; p++) {
+                const Ty *block = recv_buf + displs[p];
+                const size_t kRows = all_row_length[p];
+                const size_t kRowBegin = row_start[p];
+                for (size_t j = 0; j < kRows; j++) {
+                    for (size_t i = 0; i <= j; i++) {
+                        Ty value = *block++;
+                        gram_data[(kRowBegin + i) +
+                                  (kRowBegin + j) * kGlobalShapeN] = value;
+                        gram_data[(kRowBegin + j) +
+                                  (kRowBegin + i) * kGlobalShapeN] = value;
+                    }
+                }
+                for (size_t k = 1; k <= steps(p); k++) {
+                    const size_t kQ = (p + k) % kParN;
+                    const size_t kColBegin = row_start[kQ];
+                    for (size_t j = 0; j < all_row_length[kQ]; j++) {
+                        for (size_t i = 0; i < kRows; i++) {
+                            Ty value = *block++;
+                            gram_data[(kRowBegin + i) +
+                                      (kColBegin + j) * kGlobalShapeN] = value;
+                            gram_data[(kColBegin + j) +
+                                      (kRowBegin + i) * kGlobalShapeN] = value;
+                        }
+                    }
+                }
             }
             // Free buffers.
             A.op()->free(databuf[0]);
             A.op()->free(databuf[1]);
-            Operator<size_t>::free(all_row_length);
-            Operator<size_t>::free(gram_buf_start);
-            A.op()->free(gram_buf);
             A.op()->free(A_buf);
-            A.comm()->free_request(request_send);
-            A.comm()->free_request(request_recv);
-            Summary::end(METHOD_NAME);
+            A.op()->free(diag_buf);
+            A.op()->free(packed_buf);
+            A.op()->free(recv_buf);
+            Operator<size_t>::free(all_row_length);
+            Operator<size_t>::free(row_start);
+            Operator<size_t>::free(recvcounts);
+            Operator<size_t>::free(displs);
+            Summary::end(DIANA_EVENT_ID);
             return gram;
         }
         error("Invalid input or not implemented yet.");
@@ -133,7 +232,7 @@ namespace Function {
         if (A.distribution()->type() == Distribution::Type::kCartesianBlock
             ||
             B.distribution()->type() == Distribution::Type::kCartesianBlock) {
-            Summary::start(METHOD_NAME);
+            Summary::start(DIANA_EVENT_ID);
             for (size_t i = 0; i < A.ndim(); i++) {
                 if (i == n) continue;
                 assert(A.shape_global()[i] == B.shape_global()[i]);
@@ -194,22 +293,26 @@ namespace Function {
                     ((int) new_rank - 1 + (int) kParN) % (int) kParN;
             const int recv_from_proc_id = ((int) new_rank + 1) % (int) kParN;
             // Do gram
-            MPI_Request *request_send = A.comm()->new_request();
-            MPI_Request *request_recv = A.comm()->new_request();
+            // Persistent requests of the ring, one pair per buffer.
+            Request request_send[2] = {
+                    A.comm()->send_init(databuf[0], max_size,
+                                        send_to_proc_id, comm_fiber),
+                    A.comm()->send_init(databuf[1], max_size,
+                                        send_to_proc_id, comm_fiber)};
+            Request request_recv[2] = {
+                    A.comm()->recv_init(databuf[1], max_size,
+                                        recv_from_proc_id, comm_fiber),
+                    A.comm()->recv_init(databuf[0], max_size,
+                                        recv_from_proc_id, comm_fiber)};
             for (size_t i = 0; i < kParN; i++) {
                 if (i != 0) {
-                    A.comm()->wait(request_send);
-                    A.comm()->wait(request_recv);
+                    request_send[(i - 1) % 2].wait();
+                    request_recv[(i - 1) % 2].wait();
                 }
                 if (i != kParN - 1) {
                     //TODO: check i.
-                    A.comm()->isend(request_send, databuf[i % 2],
-                                    (int) max_size,
-                                    send_to_proc_id, comm_fiber);
-                    A.comm()->irecv(request_recv,
-                                    databuf[(i + 1) % 2],
-                                    (int) max_size,
-                                    recv_from_proc_id, comm_fiber);
+                    request_send[i % 2].start();
+                    request_recv[i % 2].start();
                 }
                 A.op()->matmulNT(gram_buf +
                                  gram_buf_start[gram_buf_point] * kALocalShapeN,
@@ -218,46 +321,256 @@ namespace Function {
                 gram_buf_point = (gram_buf_point + 1) % kParN;
             }
             // Allreduce.
-            // TODO: optimize.
-            MPI_Comm comm_line = A.comm()->comm_split(new_rank, new_color);
+            MPI_Comm comm_line = distrib->process_slice_comm(n);
             // TODO: Not inplace?
-            A.comm()->allreduce_inplace(gram_buf, (int) gram_buf_size, MPI_SUM,
+            A.comm()->allreduce_inplace(gram_buf, gram_buf_size, MPI_SUM,
                                         comm_line);
             // Gather.
-            // TODO: pack !!!!
             Tensor<Ty> gram({kAGlobalShapeN, kBGlobalShapeN}, false);
-            Ty *gram_data = gram.data();
-            int *recvcount = Operator<int>::alloc(kParN);
-            int *displs = Operator<int>::alloc(kParN);
-            recvcount[0] = (int) all_A_row_length[0];
-            displs[0] = 0;
-            for (size_t i = 1; i < kParN; i++) {
-                recvcount[i] = (int) all_A_row_length[i];
-                displs[i] = (int) displs[i - 1] + (int) all_A_row_length[i - 1];
-            }
-            for (size_t i = 0; i < kBGlobalShapeN; i++) {
-                A.comm()->allgatherv(gram_buf + i * kALocalShapeN,
-                                     (int) kALocalShapeN,
-                                     gram_data + i * kAGlobalShapeN,
-                                     recvcount, displs, comm_fiber);
-            }
+            allgather_rows_(gram.data(), gram_buf, all_A_row_length, kParN,
+                            (size_t) new_rank, kBGlobalShapeN, comm_fiber);
             // TODO: swap(A, B)
             // Free buffers.
             A.op()->free(databuf[0]);
             A.op()->free(databuf[1]);
             Operator<size_t>::free(all_B_row_length);
+            Operator<size_t>::free(all_A_row_length);
             Operator<size_t>::free(gram_buf_start);
             A.op()->free(gram_buf);
             A.op()->free(A_buf);
-            A.comm()->free_request(request_send);
-            A.comm()->free_request(request_recv);
-            Summary::end(METHOD_NAME);
+            Summary::end(DIANA_EVENT_ID);
             return gram;
         }
         error("Invalid input or not implemented yet.");
     }
 
 
+    inline size_t &ttm_chunk_size_() {
+        static size_t chunk_size = Constant::kTTMChunkSize;
+        return chunk_size;
+    }
+
+    /**
+     * @brief Set the number of elements of the partial product reduced by
+     * each step of the pipelined TTM; 0 disables the pipeline.
+     *
+     * @param size
+     */
+    inline void set_ttm_chunk_size(size_t size) { ttm_chunk_size_() = size; }
+
+    /**
+     * @brief Compute the partial product of the local block of
+     * \f$ \bm{\mathcal{A}} \f$ with the local columns of \f$ \bm{M} \f$ and
+     * reduce-scatter it over the mode-n fiber into ret.
+     *
+     * Rows of the result owned by each process of the fiber are written as a
+     * contiguous block in tensor layout, so that reduce-scatter delivers them
+     * without any reordering. When the fiber holds a single process the
+     * product is written to ret directly and work is not used.
+     *
+     * The product is computed in chunks along the last mode, which are
+     * contiguous both in A and in ret, and the reduce-scatter of each chunk
+     * is started as soon as it is computed, so it overlaps the computation of
+     * the next ones. If n is the last mode, the rows of every block are
+     * chunked instead. The number of chunks follows set_ttm_chunk_size and
+     * only depends on data shared by the fiber.
+     *
+     * @tparam Ty
+     * @param A
+     * @param M A global matrix of shape \f$ J_n \times I_n \f$
+     * @param n
+     * @param ret Result, distributed as A.
+     * @param work Buffer of \f$ J_n \f$ * A.size() / A.shape()[n] elements.
+     */
+    template<typename Ty>
+    void ttm_(const Tensor<Ty> &A, const Tensor<Ty> &M, size_t n,
+              Tensor<Ty> &ret, Ty *work) {
+        auto distrib = (DistributionCartesianBlock *) A.distribution();
+        shape_t coord = distrib->coordinate();
+        shape_t par = distrib->partition();
+        size_t row_length = M.shape()[0];
+        size_t col_length = M.shape()[1]; // M is of shape row_length * col_length.
+        size_t col_local = A.shape()[n];
+        size_t col_begin = DIANA_CEILDIV(col_length * coord[n], par[n]);
+        size_t col_end = DIANA_CEILDIV(col_length * (coord[n] + 1),
+                                       par[n]);
+        assert(col_end - col_begin == col_local);
+        Ty *data_A = A.data();
+        Ty *data_M = M.data();
+        if (par[n] == 1) {
+            A.op()->ttm(ret.data(), data_A, data_M, A.shape(), n, row_length,
+                        row_length);
+            return;
+        }
+        size_t remain_size = A.size() / col_local;
+        // Chunk along the last mode, whose extent is the same on the fiber.
+        const size_t kMode = A.ndim() - 1;
+        const size_t kExtent = kMode == n ? 0 : A.shape()[kMode];
+        size_t chunks = 1;
+        if (ttm_chunk_size_() != 0) {
+            chunks = DIANA_CEILDIV(row_length * remain_size,
+                                   ttm_chunk_size_());
+            chunks = std::min(chunks, kMode == n ? DIANA_CEILDIV(row_length,
+                                                                 par[n])
+                                                 : kExtent);
+            chunks = std::max(chunks, (size_t) 1);
+        }
+        const size_t kStrideA = kMode == n ? 0 : A.size() / kExtent;
+        const size_t kStrideRet = kMode == n ? remain_size : ret.size() /
+                                                             kExtent;
+        auto *recvcounts = Operator<size_t>::alloc(par[n] * chunks);
+        std::vector<Request> requests;
+        requests.reserve(chunks);
+        std::vector<bool> done(chunks, false);
+        std::vector<double> time_post(chunks), time_done(chunks);
+        MPI_Comm comm_fiber = distrib->process_fiber_comm(n);
+        Ty *recvbuf = ret.data();
+        size_t offset = 0;
+        auto poll = [&](size_t count) {
+            for (size_t k = 0; k < count; k++) {
+                if (!done[k] && requests[k].test()) {
+                    done[k] = true;
+                    time_done[k] = MPI_Wtime();
+                }
+            }
+        };
+        for (size_t c = 0; c < chunks; c++) {
+            // Slab of the last mode, or sub-rows of each block if it is n.
+            size_t slab_begin = 0, slab_end = 0;
+            shape_t shape = A.shape();
+            if (kMode != n) {
+                slab_begin = DIANA_CEILDIV(kExtent * c, chunks);
+                slab_end = DIANA_CEILDIV(kExtent * (c + 1), chunks);
+                shape[kMode] = slab_end - slab_begin;
+            }
+            Ty *send_chunk = work + offset;
+            for (size_t i = 0; i < par[n]; i++) {
+                size_t row_begin = DIANA_CEILDIV(row_length * i, par[n]);
+                size_t row_end = DIANA_CEILDIV(row_length * (i + 1), par[n]);
+                size_t rows = row_end - row_begin;
+                size_t count;
+                if (kMode == n) {
+                    size_t sub_begin = DIANA_CEILDIV(rows * c, chunks);
+                    size_t sub_end = DIANA_CEILDIV(rows * (c + 1), chunks);
+                    if (i == coord[n]) {
+                        recvbuf = ret.data() + sub_begin * kStrideRet;
+                    }
+                    row_begin += sub_begin;
+                    rows = sub_end - sub_begin;
+                    count = rows * remain_size;
+                } else {
+                    count = rows * remain_size / kExtent *
+                            (slab_end - slab_begin);
+                    recvbuf = ret.data() + slab_begin * kStrideRet;
+                }
+                recvcounts[c * par[n] + i] = count;
+                if (count != 0) {
+                    A.op()->ttm(work + offset,
+                                data_A + slab_begin * kStrideA,
+                                data_M + col_begin * row_length + row_begin,
+                                shape, n, rows, row_length);
+                }
+                offset += count;
+            }
+            time_post[c] = MPI_Wtime();
+            requests.push_back(ret.comm()->ireduce_scatter(
+                    send_chunk, recvbuf, recvcounts + c * par[n], MPI_SUM,
+                    comm_fiber));
+            poll(c);
+        }
+        double time_wait = MPI_Wtime();
+        for (size_t c = 0; c < chunks; c++) {
+            if (!done[c]) {
+                requests[c].wait();
+                time_done[c] = MPI_Wtime();
+            }
+        }
+        time_wait = MPI_Wtime() - time_wait;
+        // Reductions progress one after another, so each one is in flight
+        // from its start, or the end of the previous one, to its end.
+        double time_comm = 0;
+        for (size_t c = 0; c < chunks; c++) {
+            double begin = c == 0 ? time_post[c]
+                                  : std::max(time_post[c], time_done[c - 1]);
+            time_comm += std::max(time_done[c] - begin, 0.0);
+        }
+        Summary::overlap(DIANA_EVENT_ID, time_comm, time_wait);
+        Operator<size_t>::free(recvcounts);
+    }
+
+    /**
+     * @brief Multiply \f$ \bm{\mathcal{A}} \f$ by M[g] on every mode g of
+     * modes with a single reduce-scatter over the sub-grid spanned by modes.
+     *
+     * The local columns of every matrix are applied one after another,
+     * keeping all rows, so the partial product is summed over all processes
+     * of the sub-grid at once. The block owned by each of them is then packed
+     * in the rank order of DistributionCartesianBlock::process_grid_comm.
+     *
+     * @tparam Ty
+     * @param A
+     * @param M Matrices indexed by mode.
+     * @param modes Modes in the order they are applied.
+     * @param ret Result, distributed as A.
+     * @param work Two buffers, each holding the largest partial product.
+     */
+    template<typename Ty>
+    void ttm_grid_(const Tensor<Ty> &A,
+                   const std::vector<const Tensor<Ty> *> &M,
+                   const shape_t &modes, Tensor<Ty> &ret, Ty *const *work) {
+        auto distrib = (DistributionCartesianBlock *) A.distribution();
+        shape_t coord = distrib->coordinate();
+        shape_t par = distrib->partition();
+        // Local partial product.
+        shape_t shape = A.shape();
+        Ty *src = A.data();
+        size_t buf = 0;
+        for (size_t g: modes) {
+            size_t row_length = M[g]->shape()[0];
+            size_t col_begin = DIANA_CEILDIV(M[g]->shape()[1] * coord[g],
+                                             par[g]);
+            A.op()->ttm(work[buf], src,
+                        M[g]->data() + col_begin * row_length, shape, g,
+                        row_length, row_length);
+            shape[g] = row_length;
+            src = work[buf];
+            buf ^= 1;
+        }
+        // Pack the block of each process of the sub-grid.
+        shape_t sorted_modes(modes);
+        std::sort(sorted_modes.begin(), sorted_modes.end());
+        size_t grid_size = 1;
+        for (size_t g: sorted_modes) {
+            grid_size *= par[g];
+        }
+        auto *recvcounts = Operator<size_t>::alloc(grid_size);
+        shape_t begin(shape.size(), 0);
+        shape_t end(shape);
+        size_t offset = 0;
+        for (size_t r = 0; r < grid_size; r++) {
+            size_t rem = r;
+            for (size_t g: sorted_modes) {
+                size_t c = rem % par[g];
+                rem /= par[g];
+                begin[g] = DIANA_CEILDIV(shape[g] * c, par[g]);
+                end[g] = DIANA_CEILDIV(shape[g] * (c + 1), par[g]);
+            }
+            size_t count = 1;
+            for (size_t d = 0; d < shape.size(); d++) {
+                count *= end[d] - begin[d];
+            }
+            if (count != 0) {
+                A.op()->slice(work[buf] + offset, src, shape, begin, end);
+            }
+            recvcounts[r] = count;
+            offset += count;
+        }
+        MPI_Comm comm_grid = distrib->process_grid_comm(sorted_modes);
+        ret.comm()->reduce_scatter(work[buf], ret.data(), recvcounts, MPI_SUM,
+                                   comm_grid);
+        Operator<size_t>::free(recvcounts);
+    }
+
     /**
      * @brief  Calculate \f$ \bm{\mathcal{A}} \times_n \bm{M} \f$, where
      * \f$ \bm{\mathcal{A}} \f$ is a tensor and \f$ \bm{M} \f$ is a matrix.
@@ -274,74 +587,281 @@ namespace Function {
             Distribution::Type::kCartesianBlock &&
             (M.distribution() == nullptr ||
              M.distribution()->type() == Distribution::Type::kGlobal)) {
-            // Initialization
-            Summary::start(METHOD_NAME);
+            Summary::start(DIANA_EVENT_ID);
             assert(M.is_matrix());
             assert(A.shape_global()[n] == M.shape()[1]);
             auto distrib = (DistributionCartesianBlock *) A.distribution();
-            shape_t coord = distrib->coordinate();
-            shape_t par = distrib->partition();
             size_t row_length = M.shape()[0];
-            size_t col_length = M.shape()[1]; // M is of shape row_length * col_length.
-            size_t col_local = A.shape()[n];
-            size_t col_begin = DIANA_CEILDIV(col_length * coord[n], par[n]);
-            size_t col_end = DIANA_CEILDIV(col_length * (coord[n] + 1),
-                                           par[n]);
-            assert(col_end - col_begin == col_local);
-            size_t remain_size = A.size() / col_local;
-            Ty *data_A = A.data();
-            Ty *data_M = M.data();
-            Ty *data_B = A.op()->alloc(A.size());
-            Ty *data_Anew = A.op()->alloc(row_length * remain_size);
-            // Matricization
-            A.op()->tenmatt(data_B, data_A, A.shape(), n);
-            // Do TTM
-            A.op()->matmulNT(data_Anew, data_B,
-                             data_M + col_begin * row_length,
-                             remain_size, row_length, col_local);
-            // Split communicator
-            MPI_Comm comm_fiber = distrib->process_fiber_comm(n);
-            // Do reduce-scatter
             shape_t new_shape = A.shape_global();
             new_shape[n] = row_length;
             Tensor<Ty> ret(A.distribution(), new_shape, false);
-            Ty *data_ret = ret.data();
-            Ty *data_ret_buf = ret.op()->alloc(ret.size());
-            auto *recvcounts = Operator<int>::alloc(par[n]);
-            for (size_t i = 0; i < par[n]; i++) {
-                recvcounts[i] =
-                        (int) DIANA_CEILDIV(row_length * (i + 1), par[n]) -
-                        (int) DIANA_CEILDIV(row_length * i, par[n]);
-                recvcounts[i] *= (int) remain_size;
+            Ty *work = nullptr;
+            if (distrib->partition()[n] != 1) {
+                work = A.op()->alloc(row_length * A.size() / A.shape()[n]);
             }
-            ret.comm()->reduce_scatter(data_Anew, data_ret_buf, recvcounts,
-                                       MPI_SUM, comm_fiber);
-            // Tensorization
-            ret.op()->mattten(data_ret, data_ret_buf, ret.shape(), n);
-            // Free spaces
-            A.op()->free(data_B);
-            A.op()->free(data_Anew);
-            A.op()->free(data_ret_buf);
-            Operator<int>::free(recvcounts);
-            Summary::end(METHOD_NAME);
+            ttm_(A, M, n, ret, work);
+            A.op()->free(work);
+            Summary::end(DIANA_EVENT_ID);
             return ret;
         }
         error("Invalid input or not implemented yet.");
     }
 
+    /**
+     * @brief Calculate \f$ \bm{\mathcal{A}} \times_{idx_1} \bm{M}_1 \cdots
+     * \times_{idx_k} \bm{M}_k \f$.
+     *
+     * Modes are applied in the order minimizing the flops of the chain:
+     * applying mode a before mode b is cheaper iff
+     * \f$ 1/I_a - 1/J_a < 1/I_b - 1/J_b \f$, so sorting by this key is
+     * optimal. Consecutive modes are then merged into a single reduce-scatter
+     * over their joint sub-grid whenever this moves fewer elements than
+     * separate reduce-scatters, which is the case when the ranks are small.
+     * Intermediate tensors live in two buffers allocated once for the chain.
+     * With an empty idx, A itself is returned.
+     *
+     * @tparam Ty
+     * @param A
+     * @param M Matrices of shape \f$ J_{idx_i} \times I_{idx_i} \f$
+     * @param idx Distinct modes, M[i] is applied on mode idx[i].
+     * @return Tensor<Ty>
+     */
     template<typename Ty>
     Tensor<Ty>
     ttmc(const Tensor<Ty> &A, const std::vector<Tensor<Ty>> &M,
          const std::vector<size_t> &idx) {
-        Summary::start(METHOD_NAME);
-        assert(M.size() == idx.size());
-        for (size_t i = 0; i < M.size(); i++) {
-            A = ttm(A, M[i], idx[i]);
+        if (A.distribution()->type() == Distribution::Type::kCartesianBlock) {
+            assert(M.size() == idx.size());
+            if (idx.empty()) {
+                return A;
+            }
+            Summary::start(DIANA_EVENT_ID);
+            const size_t kNdim = A.ndim();
+            auto distrib = (DistributionCartesianBlock *) A.distribution();
+            shape_t par = distrib->partition();
+            std::vector<const Tensor<Ty> *> M_mode(kNdim, nullptr);
+            for (size_t i = 0; i < idx.size(); i++) {
+                assert(idx[i] < kNdim && M_mode[idx[i]] == nullptr);
+                assert(M[i].is_matrix());
+                assert(M[i].shape()[1] == A.shape_global()[idx[i]]);
+                M_mode[idx[i]] = &M[i];
+            }
+            // Order modes.
+            shape_t order(idx);
+            auto key = [&](size_t d) {
+                return 1.0 / (double) M_mode[d]->shape()[1] -
+                       1.0 / (double) M_mode[d]->shape()[0];
+            };
+            std::stable_sort(order.begin(), order.end(),
+                             [&](size_t a, size_t b) {
+                                 return key(a) < key(b);
+                             });
+            // Group modes sharing one reduce-scatter. The decision only
+            // depends on global extents, so all processes take the same one.
+            auto apply = [&](shape_t shape, const shape_t &group) {
+                for (size_t g: group) {
+                    shape[g] = M_mode[g]->shape()[0];
+                }
+                return shape;
+            };
+            auto comm_volume = [&](const shape_t &shape_global,
+                                   const shape_t &group) {
+                double size = 1;
+                size_t grid_size = 1;
+                for (size_t d = 0; d < kNdim; d++) {
+                    size *= (double) shape_global[d] / (double) par[d];
+                }
+                for (size_t g: group) {
+                    size *= (double) M_mode[g]->shape()[0] /
+                            (double) shape_global[g] * (double) par[g];
+                    grid_size *= par[g];
+                }
+                return grid_size == 1 ? 0.0 : size;
+            };
+            std::vector<shape_t> groups;
+            shape_t shape_global = A.shape_global();
+            shape_t group;
+            for (size_t d: order) {
+                if (!group.empty()) {
+                    shape_t merged(group);
+                    merged.push_back(d);
+                    double separate = comm_volume(shape_global, group) +
+                                      comm_volume(apply(shape_global, group),
+                                                  {d});
+                    if (comm_volume(shape_global, merged) < separate) {
+                        group = merged;
+                        continue;
+                    }
+                    groups.push_back(group);
+                    shape_global = apply(shape_global, group);
+                }
+                group = {d};
+            }
+            groups.push_back(group);
+            // Size the buffers from the local blocks.
+            auto volume = [](const shape_t &shape) {
+                size_t size = 1;
+                for (size_t dim: shape) {
+                    size *= dim;
+                }
+                return size;
+            };
+            size_t max_work = 0;
+            size_t max_inter = 0;
+            shape_t shape_local = A.shape();
+            shape_global = A.shape_global();
+            for (size_t k = 0; k < groups.size(); k++) {
+                shape_t shape_partial = shape_local;
+                for (size_t g: groups[k]) {
+                    shape_partial[g] = M_mode[g]->shape()[0];
+                    if (par[g] != 1 || groups[k].size() != 1) {
+                        max_work = std::max(max_work, volume(shape_partial));
+                    }
+                }
+                shape_global = apply(shape_global, groups[k]);
+                shape_local.clear();
+                distrib->get_local_shape(shape_global, shape_local);
+                if (k + 1 < groups.size()) {
+                    max_inter = std::max(max_inter, volume(shape_local));
+                }
+            }
+            // Apply the groups, with intermediates in ping-pong buffers.
+            Ty *work[2] = {A.op()->alloc(max_work), A.op()->alloc(max_work)};
+            Ty *inter[2] = {A.op()->alloc(max_inter),
+                            A.op()->alloc(max_inter)};
+            Tensor<Ty> cur = A;
+            for (size_t k = 0; k < groups.size(); k++) {
+                shape_t new_shape = apply(cur.shape_global(), groups[k]);
+                Tensor<Ty> next = k + 1 == groups.size()
+                                  ? Tensor<Ty>(A.distribution(), new_shape,
+                                               false)
+                                  : Tensor<Ty>(A.distribution(), inter[k % 2],
+                                               new_shape);
+                if (groups[k].size() == 1) {
+                    size_t n = groups[k][0];
+                    ttm_(cur, *M_mode[n], n, next, work[0]);
+                } else {
+                    ttm_grid_(cur, M_mode, groups[k], next, work);
+                }
+                cur = std::move(next);
+            }
+            for (size_t i = 0; i < 2; i++) {
+                A.op()->free(work[i]);
+                A.op()->free(inter[i]);
+            }
+            Summary::end(DIANA_EVENT_ID);
+            return cur;
+        }
+        error("Invalid input or not implemented yet.");
+    }
+
+    /**
+     * @brief Calculate \f$ \bm{\mathcal{A}} \times_1 \bm{M}_1 \cdots
+     * \times_N \bm{M}_N \f$ on every mode except skip, as used by HOOI.
+     *
+     * @tparam Ty
+     * @param A
+     * @param M One matrix per mode, M[skip] is not used.
+     * @param skip Mode left untouched, A.ndim() to apply every mode.
+     * @return Tensor<Ty>
+     */
+    template<typename Ty>
+    Tensor<Ty>
+    ttmc(const Tensor<Ty> &A, const std::vector<Tensor<Ty>> &M, size_t skip) {
+        assert(M.size() == A.ndim());
+        std::vector<Tensor<Ty>> M_used;
+        std::vector<size_t> idx;
+        for (size_t d = 0; d < A.ndim(); d++) {
+            if (d != skip) {
+                M_used.push_back(M[d]);
+                idx.push_back(d);
+            }
+        }
+        return ttmc(A, M_used, idx);
+    }
+
+    /**
+     * @brief Move the blocks of a Cartesian block distributed tensor between
+     * their owners and the processes holding the whole tensor, with one
+     * MPI_Alltoallw whose subarray datatypes place every block in its final
+     * position, so no reorder pass is needed.
+     *
+     * @tparam Ty
+     * @param distrib
+     * @param shape_global
+     * @param global Whole tensor, only used on the processes holding it.
+     * @param local Local block of this process.
+     * @param root Process holding the whole tensor, or -1 for all of them.
+     * @param to_global Gather the blocks into global if true, scatter them
+     * from global otherwise.
+     */
+    template<typename Ty>
+    void exchange_blocks_(DistributionCartesianBlock *distrib,
+                          const shape_t &shape_global, Ty *global, Ty *local,
+                          int root, bool to_global) {
+        const int kSize = mpi_size();
+        const int kRank = mpi_rank();
+        const bool kHoldsGlobal = root < 0 || kRank == root;
+        std::vector<int> local_counts((size_t) kSize, 0);
+        std::vector<int> global_counts((size_t) kSize, 0);
+        std::vector<MPI_Datatype> local_types((size_t) kSize,
+                                              Communicator<Ty>::mpi_type());
+        std::vector<MPI_Datatype> global_types(local_types);
+        // Local block, contiguous, exchanged with every holder of global.
+        shape_t local_shape;
+        distrib->get_local_shape(shape_global, local_shape);
+        MPI_Datatype local_type = MPI_DATATYPE_NULL;
+        if (distrib->local_size(shape_global) != 0) {
+            local_type = Communicator<Ty>::block_type(
+                    local_shape, local_shape, shape_t(local_shape.size(), 0));
+        }
+        for (int i = 0; i < kSize; i++) {
+            if ((root < 0 || i == root) && local_type != MPI_DATATYPE_NULL) {
+                local_counts[(size_t) i] = 1;
+                local_types[(size_t) i] = local_type;
+            }
+        }
+        // Block of every process, in place in global.
+        if (kHoldsGlobal) {
+            for (int i = 0; i < kSize; i++) {
+                shape_t shape, start, end;
+                distrib->get_local_data(i, shape_global, shape, start, end);
+                if (distrib->local_size(i, shape_global) != 0) {
+                    global_counts[(size_t) i] = 1;
+                    global_types[(size_t) i] =
+                            Communicator<Ty>::block_type(shape_global, shape,
+                                                         start);
+                }
+            }
+        }
+        if (to_global) {
+            Communicator<Ty>::alltoallw(local, local_counts.data(),
+                                        local_types.data(), global,
+                                        global_counts.data(),
+                                        global_types.data());
+        } else {
+            Communicator<Ty>::alltoallw(global, global_counts.data(),
+                                        global_types.data(), local,
+                                        local_counts.data(),
+                                        local_types.data());
+        }
+        for (int i = 0; i < kSize; i++) {
+            if (global_counts[(size_t) i] != 0) {
+                Communicator<Ty>::free_type(&global_types[(size_t) i]);
+            }
+        }
+        if (local_type != MPI_DATATYPE_NULL) {
+            Communicator<Ty>::free_type(&local_type);
         }
-        Summary::end(METHOD_NAME);
-        return A;
     }
 
+    /**
+     * @brief Gather a distributed tensor on every process, without any root.
+     *
+     * @tparam Ty
+     * @param A
+     * @return Tensor<Ty>
+     */
     template<typename Ty>
     Tensor<Ty> gather(const Tensor<Ty> &A) {
         if (A.distribution() == nullptr) {
@@ -357,44 +877,39 @@ namespace Function {
         }
         if (A.distribution()->type() ==
             Distribution::Type::kCartesianBlock) {
-            Summary::start(METHOD_NAME);
-            const int kZERO = 0;
+            Summary::start(DIANA_EVENT_ID);
             Tensor<Ty> ret(A.shape_global(), false);
-            if (A.comm()->rank() == kZERO) {
-                const int kMPISize = mpi_size();
-                int *recvcounts = new int[(size_t) kMPISize];
-                int *displs = new int[(size_t) kMPISize];
-                // Calculate recvcounts
-                for (int i = 0; i < kMPISize; i++) {
-                    recvcounts[i] =
-                            (int) A.distribution()->local_size(i,
-                                                               A.shape_global());
-                }
-                // Calculate displs
-                displs[0] = 0;
-                for (int i = 1; i < kMPISize; i++) {
-                    displs[i] = displs[i - 1] + recvcounts[i - 1];
-                }
-                // Receive data
-                A.comm()->gatherv(A.data(), (int) A.size(), ret.data(),
-                                  recvcounts,
-                                  displs, kZERO);
-                // Reorder data
-                ret.op()->reorder_from_gather_cartesian_block(
-                        ret.data(), ret.shape(),
-                        ((DistributionCartesianBlock *) A.distribution())->partition(),
-                        displs);
-                // Bcast data
-                A.comm()->bcast(ret.data(), (int) ret.size(), kZERO);
-            } else {
-                // Send data
-                A.comm()->gatherv(A.data(), (int) A.size(), nullptr,
-                                  nullptr,
-                                  nullptr, kZERO);
-                // Receive data from Bcast
-                A.comm()->bcast(ret.data(), (int) ret.size(), kZERO);
+            exchange_blocks_((DistributionCartesianBlock *) A.distribution(),
+                             A.shape_global(), ret.data(), A.data(), -1, true);
+            Summary::end(DIANA_EVENT_ID);
+            return ret;
+        }
+        error("Invalid input or not implemented yet.");
+    }
+
+    /**
+     * @brief Gather a distributed tensor on process root only. Other
+     * processes get an empty tensor.
+     *
+     * @tparam Ty
+     * @param A
+     * @param root
+     * @return Tensor<Ty>
+     */
+    template<typename Ty>
+    Tensor<Ty> gather(const Tensor<Ty> &A, int root) {
+        if (A.distribution() != nullptr &&
+            A.distribution()->type() ==
+            Distribution::Type::kCartesianBlock) {
+            Summary::start(DIANA_EVENT_ID);
+            Tensor<Ty> ret;
+            if (mpi_rank() == root) {
+                ret = Tensor<Ty>(A.shape_global(), false);
             }
-            Summary::end(METHOD_NAME);
+            exchange_blocks_((DistributionCartesianBlock *) A.distribution(),
+                             A.shape_global(), ret.data(), A.data(), root,
+                             true);
+            Summary::end(DIANA_EVENT_ID);
             return ret;
         }
         error("Invalid input or not implemented yet.");
@@ -418,56 +933,68 @@ namespace Function {
         if ((A.distribution() == nullptr ||
              A.distribution()->type() == Distribution::Type::kLocal) &&
             distribution->type() == Distribution::Type::kCartesianBlock) {
-            Summary::start(METHOD_NAME);
+            Summary::start(DIANA_EVENT_ID);
             Tensor<Ty> ret(distribution, A.shape(), false);
-            if (mpi_rank() == proc) {
-                const int kMPISize = mpi_size();
-                int *sendcounts = new int[(size_t) kMPISize];
-                int *displs = new int[(size_t) kMPISize];
-                // Calculate sendcounts
-                for (int i = 0; i < kMPISize; i++) {
-                    sendcounts[i] = (int) distribution->local_size(i,
-                                                                   A.shape());
-                }
-                // Calculate displs
-                displs[0] = 0;
-                for (int i = 1; i < kMPISize; i++) {
-                    displs[i] = displs[i - 1] + sendcounts[i - 1];
-                }
-                // Reorder data
-                A.op()->reorder_for_scatter_cartesian_block(
-                        A.data(), A.shape(),
-                        ((DistributionCartesianBlock *) distribution)->partition(),
-                        displs);
-                // Scatter data
-                ret.comm()->scatterv(A.data(), sendcounts, displs,
-                                     ret.data(),
-                                     (int) ret.size(), proc);
-                // Reorder back data
-                A.op()->reorder_from_gather_cartesian_block(
-                        A.data(), A.shape(),
-                        ((DistributionCartesianBlock *) distribution)->partition(),
-                        displs);
-            } else {
-                // Receive data
-                ret.comm()->scatterv(nullptr, nullptr, nullptr, ret.data(),
-                                     (int) ret.size(), proc);
-            }
-            Summary::end(METHOD_NAME);
+            exchange_blocks_((DistributionCartesianBlock *) distribution,
+                             A.shape(), A.data(), ret.data(), proc, false);
+            Summary::end(DIANA_EVENT_ID);
             return ret;
         }
         error("Invalid input or not implemented yet.");
     }
 
+    inline bool &reproducible_reduction_() {
+        static bool reproducible = false;
+        return reproducible;
+    }
+
+    /**
+     * @brief Choose how fnorm and sum combine the partial results of the
+     * processes. By default they are allreduced, in an order left to the MPI
+     * library; when reproducible is set they are gathered on every process
+     * and added pairwise in rank order, so that the result is the same bit
+     * for bit from run to run. Local partial results never depend on the
+     * number of threads.
+     *
+     * @param reproducible
+     */
+    inline void set_reproducible_reduction(bool reproducible) {
+        reproducible_reduction_() = reproducible;
+    }
+
+    /**
+     * @brief Add up one value per process of comm, either with an allreduce
+     * or, see set_reproducible_reduction, pairwise in rank order.
+     */
+    template<typename Ty>
+    Ty reduce_sum_(Ty value, MPI_Comm comm) {
+        if (!reproducible_reduction_()) {
+            Communicator<Ty>::allreduce_inplace(&value, 1, MPI_SUM, comm);
+            return value;
+        }
+        int size;
+        MPI_Comm_size(comm, &size);
+        const auto kSize = (size_t) size;
+        Ty *values = Operator<Ty>::alloc(kSize);
+        Communicator<Ty>::allgather(&value, 1, values, comm);
+        for (size_t s = 1; s < kSize; s *= 2) {
+            for (size_t p = 0; p + s < kSize; p += 2 * s) {
+                values[p] += values[p + s];
+            }
+        }
+        value = values[0];
+        Operator<Ty>::free(values);
+        return value;
+    }
+
     template<typename Ty>
     double fnorm(const Tensor<Ty> &A) {
         if (A.distribution()->type() ==
             Distribution::Type::kCartesianBlock) {
-            Summary::start(METHOD_NAME);
-            double ret = A.op()->fnorm(A.data(), A.size());
-            ret = ret * ret;
-            A.comm()->allreduce_inplace(&ret, 1, MPI_SUM);
-            Summary::end(METHOD_NAME);
+            Summary::start(DIANA_EVENT_ID);
+            double ret = reduce_sum_(A.op()->sqnorm(A.data(), A.size()),
+                                     MPI_COMM_WORLD);
+            Summary::end(DIANA_EVENT_ID);
             return sqrt(ret);
         } else {
             return A.op()->fnorm(A.data(), A.size());
@@ -478,10 +1005,10 @@ namespace Function {
     Ty sum(const Tensor<Ty> &A) {
         if (A.distribution()->type() ==
             Distribution::Type::kCartesianBlock) {
-            Summary::start(METHOD_NAME);
-            Ty ret = A.op()->sum(A.data(), A.size());
-            A.comm()->allreduce_inplace(&ret, 1, MPI_SUM);
-            Summary::end(METHOD_NAME);
+            Summary::start(DIANA_EVENT_ID);
+            Ty ret = reduce_sum_(A.op()->sum(A.data(), A.size()),
+                                 MPI_COMM_WORLD);
+            Summary::end(DIANA_EVENT_ID);
             return ret;
         } else {
             return A.op()->sum(A.data(), A.size());
@@ -1,14 +1,41 @@
 #include "util.hpp"
+#include "allocator.hpp"
 
 #include "summary.hpp"
 
+#include <algorithm>
+#include <tuple>
+
+#ifdef DIANA_OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @brief Get the shared, stateless operator used by all tensors.
+ *
+ * @tparam Ty
+ * @return Operator<Ty>*
+ */
+template<typename Ty>
+Operator<Ty> *Operator<Ty>::instance() {
+    static Operator<Ty> op;
+    return &op;
+}
+
+/**
+ * @brief Allocate an array of n elements from the caching Allocator.
+ *
+ * @tparam Ty
+ * @param n
+ * @return Ty* 64-byte aligned array.
+ */
 template<typename Ty>
 Ty *Operator<Ty>::alloc(size_t n) {
-    return (Ty *) std::malloc(n * sizeof(Ty));
+    return (Ty *) Allocator::alloc(n * sizeof(Ty));
 }
 
 template<typename Ty>
-void Operator<Ty>::free(Ty *A) { std::free(A); }
+void Operator<Ty>::free(Ty *A) { Allocator::free((void *) A); }
 
 template<typename Ty>
 void Operator<Ty>::mcpy(Ty *dest, Ty *src, size_t len) {
@@ -16,19 +43,556 @@ void Operator<Ty>::mcpy(Ty *dest, Ty *src, size_t len) {
     Util::memcpy((void *) dest, (void *) src, sizeof(Ty) * len);
 }
 
+/**
+ * @brief Real type underlying Ty and the number of its values per element.
+ * The elementwise kernels walk complex arrays as interleaved real arrays, so
+ * that they vectorize without going through std::complex arithmetic.
+ */
 template<typename Ty>
-void Operator<Ty>::transpose(Ty *B, Ty *A, size_t m, size_t n) {
+struct OperatorReal_ {
+    typedef Ty type;
+    static const size_t kLanes = 1;
+};
+
+template<typename Ty>
+struct OperatorReal_<std::complex<Ty>> {
+    typedef Ty type;
+    static const size_t kLanes = 2;
+};
+
+/**
+ * @brief Run body(begin, end) over [0, n), split into one range per OpenMP
+ * thread when the n items of grain reals each reach
+ * Constant::kElementwiseParallelSize reals, so that real and complex kernels
+ * go parallel at the same amount of data. Smaller calls do not open a
+ * parallel region at all, whose cost would dominate them.
+ */
+template<typename Body>
+inline void operator_parallel_(size_t n, const Body &body, size_t grain = 1) {
+#ifdef DIANA_OPENMP
+    if (n * grain >= Constant::kElementwiseParallelSize) {
+#pragma omp parallel default(none) shared(n, body)
+        {
+            const auto kThreads = (size_t) omp_get_num_threads();
+            const auto kThread = (size_t) omp_get_thread_num();
+            body(n * kThread / kThreads, n * (kThread + 1) / kThreads);
+        }
+        return;
+    }
+#endif
+    body(0, n);
+}
+
+/**
+ * @brief C = A + B elementwise.
+ */
+template<typename Ty>
+void Operator<Ty>::add(Ty *C, Ty *A, Ty *B, size_t n) {
+    typedef typename OperatorReal_<Ty>::type real_t;
+    const size_t kN = n * OperatorReal_<Ty>::kLanes;
+    DIANA_OPERATOR_FUNC_START_FW((long long) kN,
+                                 (long long) (3 * n * sizeof(Ty)));
+    auto *c = (real_t *) C;
+    auto *a = (const real_t *) A;
+    auto *b = (const real_t *) B;
+    operator_parallel_(kN, [&](size_t begin, size_t end) {
+#ifdef DIANA_OPENMP
+#pragma omp simd
+#endif
+        for (size_t i = begin; i < end; i++) {
+            c[i] = a[i] + b[i];
+        }
+    });
+}
+
+/**
+ * @brief C = A - B elementwise.
+ */
+template<typename Ty>
+void Operator<Ty>::sub(Ty *C, Ty *A, Ty *B, size_t n) {
+    typedef typename OperatorReal_<Ty>::type real_t;
+    const size_t kN = n * OperatorReal_<Ty>::kLanes;
+    DIANA_OPERATOR_FUNC_START_FW((long long) kN,
+                                 (long long) (3 * n * sizeof(Ty)));
+    auto *c = (real_t *) C;
+    auto *a = (const real_t *) A;
+    auto *b = (const real_t *) B;
+    operator_parallel_(kN, [&](size_t begin, size_t end) {
+#ifdef DIANA_OPENMP
+#pragma omp simd
+#endif
+        for (size_t i = begin; i < end; i++) {
+            c[i] = a[i] - b[i];
+        }
+    });
+}
+
+/**
+ * @brief C = A * B elementwise. Complex products are expanded by hand, i.e.
+ * without the inf/nan recovery of std::complex, which would block
+ * vectorization.
+ */
+template<typename Ty>
+void Operator<Ty>::mul(Ty *C, Ty *A, Ty *B, size_t n) {
+    typedef typename OperatorReal_<Ty>::type real_t;
+    const size_t kLanes = OperatorReal_<Ty>::kLanes;
+    DIANA_OPERATOR_FUNC_START_FW((long long) (n * (kLanes == 1 ? 1 : 6)),
+                                 (long long) (3 * n * sizeof(Ty)));
+    auto *c = (real_t *) C;
+    auto *a = (const real_t *) A;
+    auto *b = (const real_t *) B;
+    if constexpr (kLanes == 1) {
+        operator_parallel_(n, [&](size_t begin, size_t end) {
+#ifdef DIANA_OPENMP
+#pragma omp simd
+#endif
+            for (size_t i = begin; i < end; i++) {
+                c[i] = a[i] * b[i];
+            }
+        });
+    } else {
+        operator_parallel_(n, [&](size_t begin, size_t end) {
+#ifdef DIANA_OPENMP
+#pragma omp simd
+#endif
+            for (size_t i = begin; i < end; i++) {
+                const real_t kAr = a[2 * i], kAi = a[2 * i + 1];
+                const real_t kBr = b[2 * i], kBi = b[2 * i + 1];
+                c[2 * i] = kAr * kBr - kAi * kBi;
+                c[2 * i + 1] = kAr * kBi + kAi * kBr;
+            }
+        }, kLanes);
+    }
+}
+
+/**
+ * @brief C = A * B, scaling every element of A by the scalar B.
+ */
+template<typename Ty>
+void Operator<Ty>::nmul(Ty *C, Ty *A, Ty B, size_t n) {
+    typedef typename OperatorReal_<Ty>::type real_t;
+    const size_t kLanes = OperatorReal_<Ty>::kLanes;
+    DIANA_OPERATOR_FUNC_START_FW((long long) (n * (kLanes == 1 ? 1 : 6)),
+                                 (long long) (2 * n * sizeof(Ty)));
+    auto *c = (real_t *) C;
+    auto *a = (const real_t *) A;
+    if constexpr (kLanes == 1) {
+        operator_parallel_(n, [&](size_t begin, size_t end) {
+#ifdef DIANA_OPENMP
+#pragma omp simd
+#endif
+            for (size_t i = begin; i < end; i++) {
+                c[i] = a[i] * B;
+            }
+        });
+    } else {
+        const real_t kBr = B.real(), kBi = B.imag();
+        operator_parallel_(n, [&](size_t begin, size_t end) {
+#ifdef DIANA_OPENMP
+#pragma omp simd
+#endif
+            for (size_t i = begin; i < end; i++) {
+                const real_t kAr = a[2 * i], kAi = a[2 * i + 1];
+                c[2 * i] = kAr * kBr - kAi * kBi;
+                c[2 * i + 1] = kAr * kBi + kAi * kBr;
+            }
+        }, kLanes);
+    }
+}
+
+/**
+ * @brief Set all n elements of A to c.
+ */
+template<typename Ty>
+void Operator<Ty>::constant(Ty *A, Ty c, size_t n) {
+    DIANA_OPERATOR_FUNC_START_FW(0, (long long) (n * sizeof(Ty)));
+    operator_parallel_(n, [&](size_t begin, size_t end) {
+#ifdef DIANA_OPENMP
+#pragma omp simd
+#endif
+        for (size_t i = begin; i < end; i++) {
+            A[i] = c;
+        }
+    }, OperatorReal_<Ty>::kLanes);
+}
+
+/**
+ * @brief Sum, or sum of squares, of the n reals of a, accumulated in double.
+ * Lane l of ret receives the reals whose index is l modulo lanes, so that
+ * complex arrays are summed per component.
+ *
+ * The reals are cut into blocks of Constant::kReductionBlock, which are
+ * summed in parallel with Constant::kReductionLanes independent accumulators
+ * each, and the block sums are then added pairwise, along a binary tree. The
+ * blocks and the tree only depend on n, so the result is bit for bit the same
+ * for any number of threads, and the rounding error grows with log(n) instead
+ * of n.
+ */
+template<bool kSquare, typename Real>
+void operator_pairwise_sum_(double *ret, const Real *a, size_t n,
+                            size_t lanes) {
+    const size_t kBlock = Constant::kReductionBlock;
+    const size_t kBlocks = DIANA_CEILDIV(n, kBlock);
+    if (kBlocks == 0) {
+        std::fill(ret, ret + lanes, 0.0);
+        return;
+    }
+    double *partial = Operator<double>::alloc(kBlocks * lanes);
+    // Threads take whole blocks, so that the blocks do not depend on them.
+    operator_parallel_(kBlocks, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; b++) {
+            const Real *block = a + b * kBlock;
+            const size_t kLength = std::min(kBlock, n - b * kBlock);
+            double acc[Constant::kReductionLanes] = {};
+            size_t i = 0;
+            for (; i + Constant::kReductionLanes <= kLength;
+                   i += Constant::kReductionLanes) {
+#ifdef DIANA_OPENMP
+#pragma omp simd
+#endif
+                for (size_t l = 0; l < Constant::kReductionLanes; l++) {
+                    const auto kValue = (double) block[i + l];
+                    acc[l] += kSquare ? kValue * kValue : kValue;
+                }
+            }
+            for (; i < kLength; i++) {
+                const auto kValue = (double) block[i];
+                acc[i % Constant::kReductionLanes] +=
+                        kSquare ? kValue * kValue : kValue;
+            }
+            // Fold the accumulators pairwise, down to one per lane.
+            for (size_t s = Constant::kReductionLanes / 2; s >= lanes;
+                 s /= 2) {
+                for (size_t l = 0; l < s; l++) {
+                    acc[l] += acc[l + s];
+                }
+            }
+            for (size_t l = 0; l < lanes; l++) {
+                partial[b * lanes + l] = acc[l];
+            }
+        }
+    }, kBlock);
+    for (size_t s = 1; s < kBlocks; s *= 2) {
+        for (size_t b = 0; b + s < kBlocks; b += 2 * s) {
+            for (size_t l = 0; l < lanes; l++) {
+                partial[b * lanes + l] += partial[(b + s) * lanes + l];
+            }
+        }
+    }
+    std::copy(partial, partial + lanes, ret);
+    Operator<double>::free(partial);
+}
+
+/**
+ * @brief Squared Frobenius norm of the n elements of A, see
+ * operator_pairwise_sum_ for the summation order.
+ */
+template<typename Ty>
+double Operator<Ty>::sqnorm(Ty *A, size_t n) {
+    typedef typename OperatorReal_<Ty>::type real_t;
+    const size_t kN = n * OperatorReal_<Ty>::kLanes;
+    DIANA_OPERATOR_FUNC_START_FW((long long) (2 * kN),
+                                 (long long) (n * sizeof(Ty)));
+    double ret;
+    operator_pairwise_sum_<true>(&ret, (const real_t *) A, kN, 1);
+    return ret;
+}
+
+/**
+ * @brief Frobenius norm of the n elements of A.
+ */
+template<typename Ty>
+double Operator<Ty>::fnorm(Ty *A, size_t n) {
+    return std::sqrt(Operator<Ty>::sqnorm(A, n));
+}
+
+/**
+ * @brief Philox4x32-10 bijection of the counter x under the key (k0, k1),
+ * see Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC 2011.
+ */
+inline void operator_philox_(uint32_t *x, uint32_t k0, uint32_t k1) {
+    for (int r = 0; r < 10; r++) {
+        const uint64_t kP0 = (uint64_t) 0xD2511F53 * x[0];
+        const uint64_t kP1 = (uint64_t) 0xCD9E8D57 * x[2];
+        const auto kY0 = (uint32_t) (kP1 >> 32) ^ x[1] ^ k0;
+        const auto kY2 = (uint32_t) (kP0 >> 32) ^ x[3] ^ k1;
+        x[1] = (uint32_t) kP1;
+        x[3] = (uint32_t) kP0;
+        x[0] = kY0;
+        x[2] = kY2;
+        k0 += 0x9E3779B9;
+        k1 += 0xBB67AE85;
+    }
+}
+
+/**
+ * @brief Two uniform numbers in [0, 1) for each of the n global indices
+ * starting at first, drawn from the given stream.
+ */
+inline void operator_uniform_(double *u, double *v, size_t first, size_t n,
+                              uint64_t seed, uint64_t stream) {
+#ifdef DIANA_OPENMP
+#pragma omp simd
+#endif
+    for (size_t i = 0; i < n; i++) {
+        const uint64_t kIndex = first + i;
+        uint32_t x[4] = {(uint32_t) kIndex, (uint32_t) (kIndex >> 32),
+                         (uint32_t) stream, (uint32_t) (stream >> 32)};
+        operator_philox_(x, (uint32_t) seed, (uint32_t) (seed >> 32));
+        u[i] = (double) ((((uint64_t) x[1] << 32) | x[0]) >> 11) * 0x1.0p-53;
+        v[i] = (double) ((((uint64_t) x[3] << 32) | x[2]) >> 11) * 0x1.0p-53;
+    }
+}
+
+/**
+ * @brief Write to A the block [begin, end) of a random tensor of the given
+ * global shape, uniform in [0, 1) or standard normal.
+ *
+ * Every element is a function of the seed, of the stream taken by this call
+ * and of its global index only, through the counter-based Philox generator.
+ * Hence the global tensor does not depend on how it is partitioned, nor on
+ * the number of threads. Complex elements take their real and imaginary
+ * parts from the same counter, through both outputs of Box-Muller.
+ */
+template<typename Ty>
+void operator_random_(Ty *A, const shape_t &shape, const shape_t &begin,
+                      const shape_t &end, bool normal) {
+    typedef typename OperatorReal_<Ty>::type real_t;
+    const size_t kNdim = shape.size();
+    shape_t local(kNdim);
+    shape_t stride(kNdim);
+    size_t size = 1;
+    for (size_t k = 0; k < kNdim; k++) {
+        local[k] = end[k] - begin[k];
+        stride[k] = k == 0 ? 1 : stride[k - 1] * shape[k - 1];
+        size *= local[k];
+    }
+    const uint64_t kSeed = Util::random_seed();
+    const uint64_t kStream = Util::random_stream();
+    if (kNdim == 0 || size == 0) {
+        return;
+    }
+    const size_t kChunk = Constant::kRandomChunk;
+    const size_t kChunks = DIANA_CEILDIV(size, kChunk);
+#ifdef DIANA_OPENMP
+#pragma omp parallel for default(none) shared(A, begin, local, stride, kNdim, size, normal, kSeed, kStream, kChunk, kChunks)
+#endif
+    for (size_t c = 0; c < kChunks; c++) {
+        double u[Constant::kRandomChunk];
+        double v[Constant::kRandomChunk];
+        const size_t kFirst = c * kChunk;
+        const size_t kLength = std::min(kChunk, size - kFirst);
+        // Runs along mode 0 are contiguous in the global tensor too.
+        for (size_t i = 0; i < kLength;) {
+            size_t rest = kFirst + i;
+            size_t global = 0;
+            for (size_t k = 0; k < kNdim; k++) {
+                global += (begin[k] + rest % local[k]) * stride[k];
+                rest /= local[k];
+            }
+            const size_t kRun = std::min(local[0] - (kFirst + i) % local[0],
+                                         kLength - i);
+            operator_uniform_(u + i, v + i, global, kRun, kSeed, kStream);
+            i += kRun;
+        }
+        Ty *dst = A + kFirst;
+        if (normal) {
+#ifdef DIANA_OPENMP
+#pragma omp simd
+#endif
+            for (size_t i = 0; i < kLength; i++) {
+                const double kRadius = std::sqrt(-2 * std::log(1 - u[i]));
+                const double kAngle = 2 * M_PI * v[i];
+                if constexpr (OperatorReal_<Ty>::kLanes == 1) {
+                    dst[i] = (Ty) (kRadius * std::cos(kAngle));
+                } else {
+                    dst[i] = Ty((real_t) (kRadius * std::cos(kAngle)),
+                                (real_t) (kRadius * std::sin(kAngle)));
+                }
+            }
+        } else {
+#ifdef DIANA_OPENMP
+#pragma omp simd
+#endif
+            for (size_t i = 0; i < kLength; i++) {
+                if constexpr (OperatorReal_<Ty>::kLanes == 1) {
+                    dst[i] = (Ty) u[i];
+                } else {
+                    dst[i] = Ty((real_t) u[i], (real_t) v[i]);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Fill A with n uniform random numbers in [0, 1), the real and
+ * imaginary parts of complex elements being drawn independently.
+ */
+template<typename Ty>
+void Operator<Ty>::rand(Ty *A, size_t n) {
+    Operator<Ty>::rand(A, {n}, {0}, {n});
+}
+
+/**
+ * @brief Write to A the block [begin, end) of a uniform random tensor of the
+ * given global shape, see operator_random_.
+ */
+template<typename Ty>
+void Operator<Ty>::rand(Ty *A, const shape_t &shape, const shape_t &begin,
+                        const shape_t &end) {
     DIANA_OPERATOR_FUNC_START;
+    operator_random_(A, shape, begin, end, false);
+}
+
+/**
+ * @brief Fill A with n standard normal random numbers, the real and
+ * imaginary parts of complex elements being drawn independently.
+ */
+template<typename Ty>
+void Operator<Ty>::randn(Ty *A, size_t n) {
+    Operator<Ty>::randn(A, {n}, {0}, {n});
+}
+
+/**
+ * @brief Write to A the block [begin, end) of a standard normal random tensor
+ * of the given global shape, see operator_random_.
+ */
+template<typename Ty>
+void Operator<Ty>::randn(Ty *A, const shape_t &shape, const shape_t &begin,
+                         const shape_t &end) {
+    DIANA_OPERATOR_FUNC_START;
+    operator_random_(A, shape, begin, end, true);
+}
+
+/**
+ * @brief Transpose a kTile x kTile (or smaller, at the borders) tile of a
+ * column-major matrix, i.e. B[c + r * ldb] = A[r + c * lda].
+ */
+template<typename Ty>
+inline void operator_transpose_tile_(Ty *B, const Ty *A, size_t rows,
+                                     size_t cols, size_t lda, size_t ldb) {
+    // Strided loads, contiguous stores.
+    for (size_t r = 0; r < rows; r++) {
+#ifdef DIANA_OPENMP
+#pragma omp simd
+#endif
+        for (size_t c = 0; c < cols; c++) {
+            B[c + r * ldb] = A[r + c * lda];
+        }
+    }
+}
+
+/**
+ * @brief Cache-blocked batched transpose shared by transpose, tenmat,
+ * tenmatt and mattten.
+ *
+ * A holds batch column-major rows x cols matrices one after another, each
+ * element of which is a contiguous run of inner values. B receives their
+ * cols x rows transposes in the same layout, i.e.
+ * B[((c + r * cols) + b * rows * cols) * inner + k] =
+ * A[((r + c * rows) + b * rows * cols) * inner + k].
+ */
+template<typename Ty>
+void operator_transpose_batched_(Ty *B, const Ty *A, size_t rows, size_t cols,
+                                 size_t inner, size_t batch) {
+    const size_t kMatrixSize = rows * cols * inner;
+    if (rows == 1 || cols == 1) {
+        // Transposing a vector does not move anything.
+        if (B != A) {
+            Util::memcpy((void *) B, (void *) A,
+                         batch * kMatrixSize * sizeof(Ty));
+        }
+        return;
+    }
+    if (inner >= Constant::kTransposeRunLength) {
+        // Runs are long enough to stream, no tiling is needed.
+        const size_t kRuns = batch * rows * cols;
 #ifdef DIANA_OPENMP
-#pragma omp parallel for default(none) shared(B, A, m, n)
+#pragma omp parallel for default(none) shared(B, A, rows, cols, inner, kRuns, kMatrixSize)
 #endif
-    for (size_t i = 0; i < m; i++) {
-        for (size_t j = 0; j < n; j++) {
-            B[j + i * n] = A[i + j * m];
+        for (size_t idx = 0; idx < kRuns; idx++) {
+            const size_t b = idx / (rows * cols);
+            const size_t r = idx % rows;
+            const size_t c = idx / rows % cols;
+            const Ty *src = A + b * kMatrixSize + (r + c * rows) * inner;
+            Ty *dst = B + b * kMatrixSize + (c + r * cols) * inner;
+#ifdef DIANA_OPENMP
+#pragma omp simd
+#endif
+            for (size_t k = 0; k < inner; k++) {
+                dst[k] = src[k];
+            }
+        }
+        return;
+    }
+    const size_t kTile = std::max(Constant::kTransposeTile / inner,
+                                  (size_t) 4);
+    const size_t kRowTiles = DIANA_CEILDIV(rows, kTile);
+    const size_t kColTiles = DIANA_CEILDIV(cols, kTile);
+    const size_t kTiles = batch * kRowTiles * kColTiles;
+#ifdef DIANA_OPENMP
+#pragma omp parallel for default(none) shared(B, A, rows, cols, inner, kTile, kRowTiles, kColTiles, kTiles, kMatrixSize)
+#endif
+    for (size_t t = 0; t < kTiles; t++) {
+        const size_t b = t / (kRowTiles * kColTiles);
+        const size_t r0 = t % kRowTiles * kTile;
+        const size_t c0 = t / kRowTiles % kColTiles * kTile;
+        const size_t r1 = std::min(r0 + kTile, rows);
+        const size_t c1 = std::min(c0 + kTile, cols);
+        const Ty *src = A + b * kMatrixSize;
+        Ty *dst = B + b * kMatrixSize;
+        if (inner == 1) {
+            operator_transpose_tile_(dst + c0 + r0 * cols,
+                                     src + r0 + c0 * rows, r1 - r0, c1 - c0,
+                                     rows, cols);
+            continue;
+        }
+        for (size_t c = c0; c < c1; c++) {
+            for (size_t r = r0; r < r1; r++) {
+                for (size_t k = 0; k < inner; k++) {
+                    dst[(c + r * cols) * inner + k] =
+                            src[(r + c * rows) * inner + k];
+                }
+            }
         }
     }
 }
 
+/**
+ * @brief Split shape around mode n into the sizes used by the tenmat family:
+ * the product of the modes before n, shape[n], and the product of the modes
+ * after n.
+ */
+inline std::tuple<size_t, size_t, size_t>
+operator_split_shape_(const shape_t &shape, size_t n) {
+    size_t before = 1;
+    size_t after = 1;
+    for (size_t i = 0; i < n; i++) {
+        before *= shape[i];
+    }
+    for (size_t i = n + 1; i < shape.size(); i++) {
+        after *= shape[i];
+    }
+    return std::make_tuple(before, shape[n], after);
+}
+
+/**
+ * @brief Let \f$ \bm{B} = \bm{A}^T \f$, where \f$ \bm{A} \f$ is a column major
+ * matrix of shape \f$ m \times n \f$.
+ *
+ * @tparam Ty
+ * @param B
+ * @param A
+ * @param m
+ * @param n
+ */
+template<typename Ty>
+void Operator<Ty>::transpose(Ty *B, Ty *A, size_t m, size_t n) {
+    DIANA_OPERATOR_FUNC_START;
+    operator_transpose_batched_(B, A, m, n, 1, 1);
+}
+
 template<typename Ty>
 void Operator<Ty>::eye(Ty *A, size_t M) {
 #ifdef DIANA_OPENMP
@@ -57,20 +621,9 @@ void Operator<Ty>::eye(Ty *A, size_t M) {
 template<typename Ty>
 void Operator<Ty>::tenmat(Ty *B, Ty *A, const shape_t &shape, size_t n) {
     DIANA_OPERATOR_FUNC_START;
-    size_t size = Util::calc_size(shape);
-    size_t br = shape[n];            // Row block size of B.
-    size_t bc = 1;                   // Column block size of B.
-    for (size_t i = 0; i < n; i++) { // Calculate bc.
-        bc *= shape[i];
-    }
-    // Tenmat main process.
-    for (size_t idx = 0; idx < size; idx += (br * bc)) {
-        for (size_t i = 0; i < bc; i++) {
-            for (size_t j = 0; j < br; j++) {
-                B[idx + i * br + j] = A[idx + j * bc + i];
-            }
-        }
-    }
+    // Each of the `after` blocks of A is a bc x br matrix to be transposed.
+    auto[bc, br, after] = operator_split_shape_(shape, n);
+    operator_transpose_batched_(B, A, bc, br, 1, after);
 }
 
 /**
@@ -85,22 +638,9 @@ void Operator<Ty>::tenmat(Ty *B, Ty *A, const shape_t &shape, size_t n) {
 template<typename Ty>
 void Operator<Ty>::tenmatt(Ty *B, Ty *A, const shape_t &shape, size_t n) {
     DIANA_OPERATOR_FUNC_START;
-    // TODO: optimize
-    size_t size = Util::calc_size(shape);
-    size_t br = shape[n];            // Row block size of B.
-    size_t bc = 1;                   // Column block size of B.
-    for (size_t i = 0; i < n; i++) { // Calculate bc.
-        bc *= shape[i];
-    }
-    size_t col = size / br; // Column size of B;
-    // Tenmat main process.
-    for (size_t idx = 0; idx < size; idx += (br * bc)) {
-        for (size_t j = 0; j < br; j++) {
-            for (size_t i = 0; i < bc; i++) {
-                B[j * col + idx / br + i] = A[idx + j * bc + i];
-            }
-        }
-    }
+    // A is a br x after matrix of runs of length bc.
+    auto[bc, br, after] = operator_split_shape_(shape, n);
+    operator_transpose_batched_(B, A, br, after, bc, 1);
 }
 
 /**
@@ -116,29 +656,78 @@ void Operator<Ty>::tenmatt(Ty *B, Ty *A, const shape_t &shape, size_t n) {
 template<typename Ty>
 void Operator<Ty>::mattten(Ty *B, Ty *A, const shape_t &shape, size_t n) {
     DIANA_OPERATOR_FUNC_START;
-    // TODO: optimize
-    size_t size = Util::calc_size(shape);
-    size_t br = shape[n];            // Row block size of B.
-    size_t bc = 1;                   // Column block size of B.
-    for (size_t i = 0; i < n; i++) { // Calculate bc.
-        bc *= shape[i];
-    }
-    size_t col = size / br; // Column size of B;
-    // Tenmat main process.
-    for (size_t idx = 0; idx < size; idx += (br * bc)) {
-        for (size_t j = 0; j < br; j++) {
-            for (size_t i = 0; i < bc; i++) {
-                B[idx + j * bc + i] = A[j * col + idx / br + i];
-            }
+    // A is an after x br matrix of runs of length bc.
+    auto[bc, br, after] = operator_split_shape_(shape, n);
+    operator_transpose_batched_(B, A, after, br, bc, 1);
+}
+
+/**
+ * @brief Copy the block \f$ [begin, end) \f$ of the column major tensor
+ * \f$ \bm{\mathcal{A}} \f$ into the contiguous tensor \f$ \bm{\mathcal{B}}
+ * \f$ of shape \f$ end - begin \f$.
+ *
+ * @tparam Ty
+ * @param B
+ * @param A
+ * @param shape Shape of A.
+ * @param begin
+ * @param end
+ */
+template<typename Ty>
+void Operator<Ty>::slice(Ty *B, Ty *A, const shape_t &shape,
+                         const shape_t &begin, const shape_t &end) {
+    DIANA_OPERATOR_FUNC_START;
+    const size_t kNdim = shape.size();
+    const size_t kRun = end[0] - begin[0];
+    size_t runs = 1;
+    for (size_t d = 1; d < kNdim; d++) {
+        runs *= end[d] - begin[d];
+    }
+    if (kRun == 0) {
+        return;
+    }
+    shape_t stride(kNdim, 1);
+    for (size_t d = 1; d < kNdim; d++) {
+        stride[d] = stride[d - 1] * shape[d - 1];
+    }
+    // Copy contiguous runs along mode 0.
+#ifdef DIANA_OPENMP
+#pragma omp parallel for default(none) shared(B, A, begin, end, stride, kNdim, kRun, runs)
+#endif
+    for (size_t r = 0; r < runs; r++) {
+        size_t rem = r;
+        size_t offset = begin[0];
+        for (size_t d = 1; d < kNdim; d++) {
+            const size_t kExtent = end[d] - begin[d];
+            offset += (begin[d] + rem % kExtent) * stride[d];
+            rem /= kExtent;
+        }
+        const Ty *src = A + offset;
+        Ty *dst = B + r * kRun;
+#ifdef DIANA_OPENMP
+#pragma omp simd
+#endif
+        for (size_t k = 0; k < kRun; k++) {
+            dst[k] = src[k];
         }
     }
 }
 
+/**
+ * @brief Sum of the n elements of A, accumulated in double, see
+ * operator_pairwise_sum_ for the summation order.
+ */
 template<typename Ty>
 Ty Operator<Ty>::sum(Ty *A, size_t n) {
-    Ty ret = 0;
-    for (size_t i = 0; i < n; i++) {
-        ret += A[i];
+    typedef typename OperatorReal_<Ty>::type real_t;
+    const size_t kLanes = OperatorReal_<Ty>::kLanes;
+    DIANA_OPERATOR_FUNC_START_FW((long long) (n * kLanes),
+                                 (long long) (n * sizeof(Ty)));
+    double ret[kLanes];
+    operator_pairwise_sum_<false>(ret, (const real_t *) A, n * kLanes, kLanes);
+    if constexpr (kLanes == 1) {
+        return (Ty) ret[0];
+    } else {
+        return Ty((real_t) ret[0], (real_t) ret[1]);
     }
-    return ret;
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 
 #include "util.hpp"
 #include "def.hpp"
+#include "allocator.hpp"
 #include "logger.hpp"
 #include "function.hpp"
 
@@ -9,13 +10,15 @@
 #include <string>
 #include <iomanip>
 #include <cstdarg>
+#include <new>
 
 /*
- * Private member variables.
+ * Private member types.
  */
 
 template<typename Ty>
-std::map<Ty *, int> Tensor<Ty>::ref_count = std::map<Ty *, int>();
+Tensor<Ty>::Storage::Storage(Ty *data, size_t size, Owner owner)
+        : data(data), size(size), owner(owner), ref_count(1) {}
 
 /*
  * Private member functions.
@@ -23,13 +26,15 @@ std::map<Ty *, int> Tensor<Ty>::ref_count = std::map<Ty *, int>();
 
 template<typename Ty>
 inline void Tensor<Ty>::init_by_shape(const shape_t &shape) {
-    this->op_ = new Operator<Ty>();
+    this->op_ = Operator<Ty>::instance();
     this->ndim_ = shape.size();
     /**
      * Assert that the input shape indicates a tensor.
      * Zero order tensor is a scalar, which is also a kind of tensor.
      **/
     assert(this->ndim_ >= 0);
+    this->is_matrix_ = false;
+    this->trans_ = Transpose::kN;
     this->shape_ = shape_t();
     this->stride_ = shape_t();
     this->stride_in_bytes_ = shape_t();
@@ -70,11 +75,57 @@ inline void Tensor<Ty>::init_by_distribution(const shape_t &shape,
     this->distribution_->get_local_shape(this->shape_global_, shape_local);
     this->init_by_shape(shape_local);
 
-    this->comm_ = new Communicator<Ty>();
+    this->comm_ = Communicator<Ty>::instance();
     this->comm_rank_ = this->comm_->rank();
     this->comm_size_ = this->comm_->size();
 }
 
+/**
+ * @brief Wrap data into a new Storage with reference count one.
+ *
+ * The Storage block itself is taken from the caching Allocator, so building
+ * a tensor does not reach the system allocator in steady state.
+ *
+ * @tparam Ty
+ * @param data
+ * @param owner Whether data should be freed with the last reference.
+ */
+template<typename Ty>
+inline void Tensor<Ty>::init_storage(Ty *data,
+                                     typename Storage::Owner owner) {
+    this->data_ = data;
+    this->storage_ = new(Allocator::alloc(sizeof(Storage)))
+            Storage(data, this->size_, owner);
+}
+
+template<typename Ty>
+inline void Tensor<Ty>::retain_storage() {
+    if (this->storage_ != nullptr) {
+        this->storage_->ref_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Drop this tensor's reference to its storage, freeing the data if
+ * it was the last one.
+ *
+ * @tparam Ty
+ */
+template<typename Ty>
+inline void Tensor<Ty>::release_storage() {
+    if (this->storage_ != nullptr &&
+        this->storage_->ref_count.fetch_sub(1, std::memory_order_acq_rel) ==
+        1) {
+        if (this->storage_->owner == Storage::Owner::kOperator) {
+            Operator<Ty>::free(this->storage_->data);
+        }
+        this->storage_->~Storage();
+        Allocator::free(this->storage_);
+    }
+    this->storage_ = nullptr;
+    this->data_ = nullptr;
+}
+
 template<typename Ty>
 inline void Tensor<Ty>::assert_shape(const Tensor<Ty> &A, const Tensor<Ty> &B) {
 #ifndef DIANA_PERFORMANCE_MODE
@@ -131,9 +182,17 @@ inline int Tensor<Ty>::shape_t_to_index(const shape_t &idx) {
 template<typename Ty>
 Tensor<Ty>::Tensor() {
     this->data_ = nullptr;
+    this->storage_ = nullptr;
+    this->ndim_ = 0;
+    this->size_ = 0;
+    this->is_matrix_ = false;
+    this->trans_ = Transpose::kN;
     this->op_ = nullptr;
+    this->size_global_ = 0;
     this->distribution_ = nullptr;
     this->comm_ = nullptr;
+    this->comm_size_ = 0;
+    this->comm_rank_ = 0;
 }
 
 /**
@@ -153,7 +212,7 @@ Tensor<Ty>::Tensor(Ty *A, const shape_t &shape) {
     this->comm_ = nullptr;
     this->init_by_shape(shape);
 
-    this->data_ = A;
+    this->init_storage(A, Storage::Owner::kExternal);
 }
 
 /**
@@ -172,8 +231,8 @@ Tensor<Ty>::Tensor(const shape_t &shape, bool zero) {
     this->comm_ = nullptr;
     this->init_by_shape(shape);
 
-    this->data_ = this->op_->alloc(this->size_);
-    Tensor<Ty>::ref_count[this->data_]++;
+    this->init_storage(this->op_->alloc(this->size_),
+                       Storage::Owner::kOperator);
     if (zero) {
         this->op_->constant(this->data_, 0, this->size_);
     }
@@ -195,8 +254,8 @@ Tensor<Ty>::Tensor(Distribution *distribution, Ty *A, const shape_t &shape) {
     assert(A != nullptr);
     this->init_by_distribution(shape, distribution);
 
-    this->data_ = A;
-    // Do not add ref_count here, A is an external input.
+    // A is an external input, it will not be freed by this tensor.
+    this->init_storage(A, Storage::Owner::kExternal);
 }
 
 /**
@@ -212,8 +271,8 @@ Tensor<Ty>::Tensor(Distribution *distribution, const shape_t &shape,
                    bool zero) {
     this->init_by_distribution(shape, distribution);
 
-    this->data_ = this->op_->alloc(this->size_);
-    Tensor<Ty>::ref_count[this->data_]++;
+    this->init_storage(this->op_->alloc(this->size_),
+                       Storage::Owner::kOperator);
     if (zero) {
         this->op_->constant(this->data_, 0, this->size_);
     }
@@ -226,25 +285,41 @@ Tensor<Ty>::Tensor(Distribution *distribution, const shape_t &shape,
  * @param t
  */
 template<typename Ty>
-Tensor<Ty>::Tensor(const Tensor<Ty> &t) {
-    if (t.distribution() != nullptr) {
-        this->init_by_distribution(t.shape_global(), t.distribution());
-    } else {
-        if (t.data() == nullptr) {
-            this->op_ = nullptr;
-            this->distribution_ = nullptr;
-            this->comm_ = nullptr;
-        } else {
-            this->distribution_ = nullptr;
-            this->comm_ = nullptr;
-            this->init_by_shape(t.shape());
-        }
-    }
+Tensor<Ty>::Tensor(const Tensor<Ty> &t)
+        : data_(t.data_), storage_(t.storage_), ndim_(t.ndim_),
+          size_(t.size_), shape_(t.shape_), stride_(t.stride_),
+          stride_in_bytes_(t.stride_in_bytes_), is_matrix_(t.is_matrix_),
+          trans_(t.trans_), op_(t.op_), size_global_(t.size_global_),
+          shape_global_(t.shape_global_), distribution_(t.distribution_),
+          comm_(t.comm_), comm_size_(t.comm_size_),
+          comm_rank_(t.comm_rank_) {
+    this->retain_storage();
+}
 
-    this->data_ = t.data();
-    if (this->data_ != nullptr) {
-        Tensor<Ty>::ref_count[this->data_]++;
-    }
+/**
+ * @brief Construct a new Tensor<Ty>:: Tensor object, move constructor.
+ *
+ * Steal data and metadata from t, leaving t as a default-constructed tensor.
+ *
+ * @tparam Ty
+ * @param t
+ */
+template<typename Ty>
+Tensor<Ty>::Tensor(Tensor<Ty> &&t) noexcept
+        : data_(t.data_), storage_(t.storage_), ndim_(t.ndim_),
+          size_(t.size_), shape_(std::move(t.shape_)),
+          stride_(std::move(t.stride_)),
+          stride_in_bytes_(std::move(t.stride_in_bytes_)),
+          is_matrix_(t.is_matrix_), trans_(t.trans_), op_(t.op_),
+          size_global_(t.size_global_),
+          shape_global_(std::move(t.shape_global_)),
+          distribution_(t.distribution_), comm_(t.comm_),
+          comm_size_(t.comm_size_), comm_rank_(t.comm_rank_) {
+    t.data_ = nullptr;
+    t.storage_ = nullptr;
+    t.op_ = nullptr;
+    t.distribution_ = nullptr;
+    t.comm_ = nullptr;
 }
 
 /**
@@ -254,17 +329,7 @@ Tensor<Ty>::Tensor(const Tensor<Ty> &t) {
  */
 template<typename Ty>
 Tensor<Ty>::~Tensor() {
-    delete this->op_;
-    delete this->comm_;
-    if (this->data_ == nullptr) {
-        return;
-    }
-    if (Tensor<Ty>::ref_count[this->data_] > 0) {
-        Tensor<Ty>::ref_count[this->data_]--;
-        if (Tensor<Ty>::ref_count[this->data_] == 0) {
-            this->op_->free(this->data_);
-        }
-    }
+    this->release_storage();
 }
 
 /**
@@ -402,7 +467,7 @@ Tensor<Ty> Tensor<Ty>::scatter(Distribution *distribution, int proc) {
 
 template<typename Ty>
 void Tensor<Ty>::sync(int proc) {
-    this->comm_->bcast(this->data_, (int) this->size_, proc);
+    this->comm_->bcast(this->data_, this->size_, proc);
 }
 
 template<typename Ty>
@@ -423,23 +488,58 @@ Ty &Tensor<Ty>::operator()(size_t x, ...) {
 }
 
 template<typename Ty>
-const Tensor<Ty> Tensor<Ty>::operator=(const Tensor<Ty> &t) {
-    if (t.distribution() != nullptr) {
-        this->init_by_distribution(t.shape_global(), t.distribution());
-    } else {
-        this->init_by_shape(t.shape());
+Tensor<Ty> &Tensor<Ty>::operator=(const Tensor<Ty> &t) {
+    if (this == &t) {
+        return *this;
     }
+    this->release_storage();
+    this->data_ = t.data_;
+    this->storage_ = t.storage_;
+    this->retain_storage();
+    this->ndim_ = t.ndim_;
+    this->size_ = t.size_;
+    this->shape_ = t.shape_;
+    this->stride_ = t.stride_;
+    this->stride_in_bytes_ = t.stride_in_bytes_;
+    this->is_matrix_ = t.is_matrix_;
+    this->trans_ = t.trans_;
+    this->op_ = t.op_;
+    this->size_global_ = t.size_global_;
+    this->shape_global_ = t.shape_global_;
+    this->distribution_ = t.distribution_;
+    this->comm_ = t.comm_;
+    this->comm_size_ = t.comm_size_;
+    this->comm_rank_ = t.comm_rank_;
+    return *this;
+}
 
-    if (this->data_ != nullptr) {
-        Tensor<Ty>::ref_count[this->data_]--;
-        if (Tensor<Ty>::ref_count[this->data_] == 0) {
-            this->op_->free(this->data_);
-        }
-    }
-    this->data_ = t.data();
-    if (this->data_ != nullptr) {
-        Tensor<Ty>::ref_count[this->data_]++;
+template<typename Ty>
+Tensor<Ty> &Tensor<Ty>::operator=(Tensor<Ty> &&t) noexcept {
+    if (this == &t) {
+        return *this;
     }
+    this->release_storage();
+    this->data_ = t.data_;
+    this->storage_ = t.storage_;
+    this->ndim_ = t.ndim_;
+    this->size_ = t.size_;
+    this->shape_ = std::move(t.shape_);
+    this->stride_ = std::move(t.stride_);
+    this->stride_in_bytes_ = std::move(t.stride_in_bytes_);
+    this->is_matrix_ = t.is_matrix_;
+    this->trans_ = t.trans_;
+    this->op_ = t.op_;
+    this->size_global_ = t.size_global_;
+    this->shape_global_ = std::move(t.shape_global_);
+    this->distribution_ = t.distribution_;
+    this->comm_ = t.comm_;
+    this->comm_size_ = t.comm_size_;
+    this->comm_rank_ = t.comm_rank_;
+    t.data_ = nullptr;
+    t.storage_ = nullptr;
+    t.op_ = nullptr;
+    t.distribution_ = nullptr;
+    t.comm_ = nullptr;
     return *this;
 }
 
@@ -454,14 +554,38 @@ void Tensor<Ty>::zeros() { this->constant(0); }
 template<typename Ty>
 void Tensor<Ty>::ones() { this->constant(1); }
 
+/**
+ * @brief Fill the tensor with uniform random numbers in [0, 1). A
+ * distributed tensor receives its block of the same global tensor for any
+ * partition, see Operator<Ty>::rand.
+ */
 template<typename Ty>
 void Tensor<Ty>::rand() {
-    this->op_->rand(this->data_, this->size_);
+    if (this->distribution_ != nullptr) {
+        shape_t shape, begin, end;
+        this->distribution_->get_local_data(this->shape_global_, shape, begin,
+                                            end);
+        this->op_->rand(this->data_, this->shape_global_, begin, end);
+    } else {
+        this->op_->rand(this->data_, this->size_);
+    }
 }
 
+/**
+ * @brief Fill the tensor with standard normal random numbers. A distributed
+ * tensor receives its block of the same global tensor for any partition, see
+ * Operator<Ty>::randn.
+ */
 template<typename Ty>
 void Tensor<Ty>::randn() {
-    this->op_->randn(this->data_, this->size_);
+    if (this->distribution_ != nullptr) {
+        shape_t shape, begin, end;
+        this->distribution_->get_local_data(this->shape_global_, shape, begin,
+                                            end);
+        this->op_->randn(this->data_, this->shape_global_, begin, end);
+    } else {
+        this->op_->randn(this->data_, this->size_);
+    }
 }
 
 template<typename Ty>
@@ -512,10 +636,8 @@ void Tensor<Ty>::permute(const shape_t &perm) {
     // Reinit by shape.
     this->init_by_shape(shape_new);
     // Change data.
-    Tensor<Ty>::ref_count[this->data_]--;
-    this->op_->free(this->data_);
-    this->data_ = data_new;
-    Tensor<Ty>::ref_count[this->data_]++;
+    this->release_storage();
+    this->init_storage(data_new, Storage::Owner::kOperator);
 }
 
 template<typename Ty>
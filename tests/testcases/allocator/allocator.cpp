@@ -0,0 +1,44 @@
+//
+// Hits, misses and cache limit of Allocator.
+//
+
+#include "allocator.hpp"
+#include "gtest/gtest.h"
+
+#include <cstdint>
+
+TEST(Allocator, Cache) {
+    // Sizes no other test asks for, and an empty cache, which earlier tests
+    // may have filled up to the peak.
+    Allocator::release();
+    const size_t kSmall = 12345;
+    const size_t kHuge = 3 * Constant::kHugePageSize + 7;
+    auto before = Allocator::statistics();
+    void *small = Allocator::alloc(kSmall);
+    void *huge = Allocator::alloc(kHuge);
+    EXPECT_EQ((uintptr_t) small % Constant::kAllocatorAlignment, (uintptr_t) 0);
+    EXPECT_EQ((uintptr_t) huge % Constant::kHugePageSize, (uintptr_t) 0);
+    auto after = Allocator::statistics();
+    EXPECT_EQ(after.miss - before.miss, (size_t) 2);
+    // Freed blocks are served again from the cache.
+    Allocator::free(small);
+    Allocator::free(huge);
+    before = Allocator::statistics();
+    EXPECT_EQ(Allocator::alloc(kSmall), small);
+    EXPECT_EQ(Allocator::alloc(kHuge), huge);
+    after = Allocator::statistics();
+    EXPECT_EQ(after.hit - before.hit, (size_t) 2);
+    EXPECT_EQ(after.miss, before.miss);
+    // Without room in the cache, blocks go back to the system.
+    Allocator::set_cache_limit(0);
+    EXPECT_EQ(Allocator::statistics().bytes_cached, (size_t) 0);
+    Allocator::free(small);
+    Allocator::free(huge);
+    EXPECT_EQ(Allocator::statistics().bytes_cached, (size_t) 0);
+    before = Allocator::statistics();
+    small = Allocator::alloc(kSmall);
+    after = Allocator::statistics();
+    EXPECT_EQ(after.miss - before.miss, (size_t) 1);
+    Allocator::free(small);
+    Allocator::set_cache_limit(SIZE_MAX);
+}
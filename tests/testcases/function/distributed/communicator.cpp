@@ -0,0 +1,91 @@
+//
+// Counts beyond mpi_max_count() through the split paths of Communicator, at
+// the default INT_MAX and at a small limit.
+//
+
+#include "FunctionDistributedTest.hpp"
+
+#include <climits>
+#include <memory>
+
+namespace {
+    // More than 2^31 bytes, with a remainder past the INT_MAX-element blocks.
+    const size_t kLarge = ((size_t) 1 << 31) + 3;
+    // Only every kStride-th byte and the last one are written and checked,
+    // so that the untouched pages of the buffers take no memory.
+    const size_t kStride = ((size_t) 1 << 20) + 7;
+
+    char value_(size_t i) { return (char) (i % 127 + 1); }
+
+    void fill_(char *A, size_t n) {
+        for (size_t i = 0; i < n; i += kStride) {
+            A[i] = value_(i);
+        }
+        A[n - 1] = value_(n - 1);
+    }
+
+    void expect_filled_(const char *A, size_t n) {
+        for (size_t i = 0; i < n; i += kStride) {
+            ASSERT_EQ(A[i], value_(i)) << "at " << i;
+        }
+        EXPECT_EQ(A[n - 1], value_(n - 1));
+    }
+} // namespace
+
+TEST_F(FunctionDistributedTest, CommunicatorLarge) {
+    // Processes 0 and 1 broadcast, process 0 alone gathers, so that at most
+    // one process holds a full buffer at a time.
+    const int kRank = mpi_rank();
+    MPI_Comm pair = Communicator<char>::comm_split(
+            kRank < 2 ? 0 : MPI_UNDEFINED, kRank);
+    if (pair != MPI_COMM_NULL) {
+        std::unique_ptr<char[]> A(new char[kLarge]);
+        if (kRank == 0) {
+            fill_(A.get(), kLarge);
+        }
+        Communicator<char>::bcast(A.get(), kLarge, 0, pair);
+        expect_filled_(A.get(), kLarge);
+        A.reset();
+        Communicator<char>::barrier(pair);
+        Communicator<char>::comm_free(&pair);
+    }
+    MPI_Comm self = Communicator<char>::comm_split(
+            kRank == 0 ? 0 : MPI_UNDEFINED, kRank);
+    if (self != MPI_COMM_NULL) {
+        // A block beyond INT_MAX, at a displacement.
+        const size_t kDispl = 5;
+        std::unique_ptr<char[]> send(new char[kLarge]);
+        std::unique_ptr<char[]> recv(new char[kDispl + kLarge]);
+        fill_(send.get(), kLarge);
+        Communicator<char>::allgatherv(send.get(), kLarge, recv.get(),
+                                       &kLarge, &kDispl, self);
+        expect_filled_(recv.get() + kDispl, kLarge);
+        Communicator<char>::comm_free(&self);
+    }
+}
+
+TEST_F(FunctionDistributedTest, CommunicatorSmallMaxCount) {
+    // Initialization
+    auto *dis_global = new DistributionGlobal();
+    Tensor<double> m(dis_global, {3, 4});
+    for (size_t i = 0; i < m.size(); i++) {
+        m[i] = (double) i;
+    }
+    // Calculate, with every message of the allgatherv of gram and the
+    // reduce-scatters of ttm split or sent as a derived datatype.
+    mpi_set_max_count(4);
+    auto ans_gram = Function::gram<double>(t, 1);
+    auto ans_ttm = Function::ttm<double>(t, m, 1);
+    mpi_set_max_count(INT_MAX);
+    // Ground Truth
+    auto truth_gram = Function::gram<double>(t, 1);
+    auto truth_ttm = Function::gather(Function::ttm<double>(t, m, 1));
+    ans_ttm = Function::gather(ans_ttm);
+    for (size_t i = 0; i < ans_gram.size(); i++) {
+        EXPECT_DOUBLE_EQ(ans_gram[i], truth_gram[i]);
+    }
+    ASSERT_EQ(ans_ttm.size(), truth_ttm.size());
+    for (size_t i = 0; i < ans_ttm.size(); i++) {
+        EXPECT_DOUBLE_EQ(ans_ttm[i], truth_ttm[i]);
+    }
+}
@@ -0,0 +1,38 @@
+//
+// Function::scatter and Function::gather, which move every block as one
+// subarray datatype whatever mpi_max_count().
+//
+
+#include "FunctionDistributedTest.hpp"
+
+TEST_F(FunctionDistributedTest, ScatterGather) {
+    // Initialization, mode 1 is not a multiple of the process count, so the
+    // blocks differ in width. Scatter from and gather to ranks other than 0
+    // whenever there are several processes.
+    const auto kP = (size_t) mpi_size();
+    const int kScatterRoot = (int) (1 % kP);
+    const int kGatherRoot = (int) (kP - 1);
+    auto *distribution = new DistributionCartesianBlock({1, kP, 1},
+                                                        mpi_rank());
+    Tensor<double> A({3, 2 * kP + 2, 2}, false);
+    for (size_t i = 0; i < A.size(); i++) {
+        A[i] = (double) i;
+    }
+    // Calculate
+    auto scattered = Function::scatter(A, distribution, kScatterRoot);
+    auto ans = Function::gather(scattered);
+    auto ans_root = Function::gather(scattered, kGatherRoot);
+    // Ground Truth
+    ASSERT_EQ(ans.size(), A.size());
+    for (size_t i = 0; i < A.size(); i++) {
+        EXPECT_DOUBLE_EQ(ans[i], A[i]);
+    }
+    if (mpi_rank() == kGatherRoot) {
+        ASSERT_EQ(ans_root.size(), A.size());
+        for (size_t i = 0; i < A.size(); i++) {
+            EXPECT_DOUBLE_EQ(ans_root[i], A[i]);
+        }
+    } else {
+        EXPECT_EQ(ans_root.size(), (size_t) 0);
+    }
+}
@@ -0,0 +1,41 @@
+//
+// Random tensors do not depend on the partition.
+//
+
+#include "FunctionDistributedTest.hpp"
+
+TEST_F(FunctionDistributedTest, RandnPartition) {
+    // Initialization
+    const shape_t kShape = {20, 16, 14};
+    const auto kP = (size_t) mpi_size();
+    auto *distribution_0 = new DistributionCartesianBlock({kP, 1, 1},
+                                                          mpi_rank());
+    auto *distribution_1 = new DistributionCartesianBlock({1, 1, kP},
+                                                          mpi_rank());
+    // Calculate, restarting the generator before every tensor.
+    Tensor<double> ans_local(kShape, false);
+    Util::set_random_seed(7);
+    ans_local.randn();
+    Util::set_random_seed(7);
+    Tensor<double> t_0(distribution_0, kShape, false);
+    t_0.randn();
+    Util::set_random_seed(7);
+    Tensor<double> t_1(distribution_1, kShape, false);
+    t_1.randn();
+    auto ans_0 = Function::gather(t_0);
+    auto ans_1 = Function::gather(t_1);
+    Util::set_random_seed(Constant::kRandomSeed);
+    // Ground Truth
+    double mean = 0;
+    double var = 0;
+    for (size_t i = 0; i < ans_local.size(); i++) {
+        EXPECT_EQ(ans_0[i], ans_local[i]);
+        EXPECT_EQ(ans_1[i], ans_local[i]);
+        mean += ans_local[i];
+        var += ans_local[i] * ans_local[i];
+    }
+    mean /= (double) ans_local.size();
+    var = var / (double) ans_local.size() - mean * mean;
+    EXPECT_NEAR(mean, 0, 0.1);
+    EXPECT_NEAR(var, 1, 0.1);
+}
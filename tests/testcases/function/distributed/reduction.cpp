@@ -0,0 +1,69 @@
+//
+// Accuracy and reproducibility of Function::fnorm and Function::sum.
+//
+
+#include "FunctionDistributedTest.hpp"
+
+#ifdef DIANA_OPENMP
+#include <omp.h>
+#endif
+
+TEST_F(FunctionDistributedTest, Reduction) {
+    // Initialization, several reduction blocks and parallel chunks per
+    // process: 4 * Constant::kElementwiseParallelSize elements each.
+    auto *distribution = new DistributionCartesianBlock(
+            {1, (size_t) mpi_size(), 1}, mpi_rank());
+    Tensor<double> A({128, 128 * (size_t) mpi_size(), 8}, false);
+    long double truth_sum = 0;
+    long double truth_sqnorm = 0;
+    for (size_t i = 0; i < A.size(); i++) {
+        A[i] = 1.0 / (double) (i + 1) - 0.25;
+        truth_sum += (long double) A[i];
+        truth_sqnorm += (long double) A[i] * (long double) A[i];
+    }
+    auto t = Function::scatter(A, distribution, 0);
+    ASSERT_GE(t.size(), 4 * Constant::kElementwiseParallelSize);
+    // Calculate
+    double ans_fnorm = Function::fnorm(t);
+    double ans_sum = Function::sum(t);
+    Function::set_reproducible_reduction(true);
+    double ans_fnorm_ordered = Function::fnorm(t);
+    double ans_sum_ordered = Function::sum(t);
+#ifdef DIANA_OPENMP
+    const int kThreads = omp_get_max_threads();
+    omp_set_num_threads(kThreads == 1 ? 3 : 1);
+    EXPECT_EQ(Function::fnorm(t), ans_fnorm_ordered);
+    EXPECT_EQ(Function::sum(t), ans_sum_ordered);
+    omp_set_num_threads(kThreads);
+#endif
+    Function::set_reproducible_reduction(false);
+    // Ground Truth
+    const auto kFnorm = (double) std::sqrt(truth_sqnorm);
+    const auto kSum = (double) truth_sum;
+    EXPECT_NEAR(ans_fnorm, kFnorm, 1e-14 * kFnorm);
+    EXPECT_NEAR(ans_sum, kSum, 1e-14 * std::abs(kSum));
+    EXPECT_NEAR(ans_fnorm_ordered, kFnorm, 1e-14 * kFnorm);
+    EXPECT_NEAR(ans_sum_ordered, kSum, 1e-14 * std::abs(kSum));
+}
+
+TEST_F(FunctionDistributedTest, ReductionThreads) {
+#ifndef DIANA_OPENMP
+    GTEST_SKIP() << "Built without OpenMP.";
+#else
+    // Not a multiple of the block size, so the last block is partial.
+    const size_t kN = 5 * Constant::kElementwiseParallelSize + 123;
+    double *A = Operator<double>::alloc(kN);
+    for (size_t i = 0; i < kN; i++) {
+        A[i] = std::sin((double) i) + 1.0 / (double) (i + 1);
+    }
+    const int kThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    const double kSum = Operator<double>::sum(A, kN);
+    const double kSqnorm = Operator<double>::sqnorm(A, kN);
+    omp_set_num_threads(kThreads == 1 ? 4 : kThreads);
+    EXPECT_EQ(Operator<double>::sum(A, kN), kSum);
+    EXPECT_EQ(Operator<double>::sqnorm(A, kN), kSqnorm);
+    omp_set_num_threads(kThreads);
+    Operator<double>::free(A);
+#endif
+}
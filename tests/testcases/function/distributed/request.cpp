@@ -0,0 +1,97 @@
+//
+// Non-blocking and persistent collectives of Communicator against the
+// blocking ones, with and without splitting into calls of mpi_max_count().
+//
+
+#include "FunctionDistributedTest.hpp"
+
+#include <climits>
+
+namespace {
+    void expect_requests_() {
+        const auto kSize = (size_t) mpi_size();
+        const auto kRank = (size_t) mpi_rank();
+        // Integer values, so every reduction order gives the same result.
+        const size_t kN = 50;
+        std::vector<double> send(kN * kSize);
+        std::vector<size_t> counts(kSize), displs(kSize);
+        size_t total = 0;
+        for (size_t p = 0; p < kSize; p++) {
+            counts[p] = 5 + 3 * p;
+            displs[p] = total;
+            total += counts[p];
+        }
+        auto fill = [&](int round) {
+            for (size_t i = 0; i < send.size(); i++) {
+                send[i] = (double) ((i * 7 + kRank * 13 + (size_t) round) % 31);
+            }
+        };
+        std::vector<double> ans(kN * kSize), truth(kN * kSize);
+        // Non-blocking, started once.
+        fill(0);
+        Communicator<double>::iallreduce(send.data(), ans.data(), kN, MPI_SUM)
+                .wait();
+        Communicator<double>::allreduce(send.data(), truth.data(), kN,
+                                        MPI_SUM);
+        for (size_t i = 0; i < kN; i++) {
+            EXPECT_EQ(ans[i], truth[i]);
+        }
+        auto request = Communicator<double>::iallgatherv(
+                send.data(), counts[kRank], ans.data(), counts.data(),
+                displs.data());
+        while (!request.test()) {}
+        Communicator<double>::allgatherv(send.data(), counts[kRank],
+                                         truth.data(), counts.data(),
+                                         displs.data());
+        for (size_t i = 0; i < total; i++) {
+            EXPECT_EQ(ans[i], truth[i]);
+        }
+        // Persistent, started with new data every round.
+        std::vector<double> ans_allreduce(kN), ans_allgatherv(total);
+        std::vector<double> ans_reduce_scatter(counts[kRank]);
+        auto allreduce = Communicator<double>::allreduce_init(
+                send.data(), ans_allreduce.data(), kN, MPI_SUM);
+        auto reduce_scatter = Communicator<double>::reduce_scatter_init(
+                send.data(), ans_reduce_scatter.data(), counts.data(),
+                MPI_SUM);
+        auto allgatherv = Communicator<double>::allgatherv_init(
+                send.data(), counts[kRank], ans_allgatherv.data(),
+                counts.data(), displs.data());
+        for (int round = 1; round <= 3; round++) {
+            fill(round);
+            allreduce.start();
+            allreduce.wait();
+            Communicator<double>::allreduce(send.data(), truth.data(), kN,
+                                            MPI_SUM);
+            for (size_t i = 0; i < kN; i++) {
+                EXPECT_EQ(ans_allreduce[i], truth[i]);
+            }
+            reduce_scatter.start();
+            reduce_scatter.wait();
+            Communicator<double>::reduce_scatter(send.data(), truth.data(),
+                                                 counts.data(), MPI_SUM);
+            for (size_t i = 0; i < counts[kRank]; i++) {
+                EXPECT_EQ(ans_reduce_scatter[i], truth[i]);
+            }
+            allgatherv.start();
+            while (!allgatherv.test()) {}
+            Communicator<double>::allgatherv(send.data(), counts[kRank],
+                                             truth.data(), counts.data(),
+                                             displs.data());
+            for (size_t i = 0; i < total; i++) {
+                EXPECT_EQ(ans_allgatherv[i], truth[i]);
+            }
+        }
+    }
+} // namespace
+
+TEST_F(FunctionDistributedTest, Requests) {
+    expect_requests_();
+}
+
+TEST_F(FunctionDistributedTest, RequestsSmallMaxCount) {
+    // Every message split, or sent as a derived datatype.
+    mpi_set_max_count(4);
+    expect_requests_();
+    mpi_set_max_count(INT_MAX);
+}
@@ -34,4 +34,100 @@ TEST_F(FunctionDistributedTest, TTM1) {
             EXPECT_DOUBLE_EQ(ans[i], ground_truth[i]);
         }
     }
-}
\ No newline at end of file
+}
+TEST_F(FunctionDistributedTest, TTM2) {
+    // Initialization
+    auto *dis_global = new DistributionGlobal();
+    Tensor<double> m(dis_global, {2, 5});
+    for (size_t i = 0; i < m.size(); i++) {
+        m[i] = (double) i;
+    }
+    // Calculate
+    t = Function::ttm<double>(t, m, 0);
+    // Gather
+    auto ans = Function::gather(t);
+    // Ground Truth
+    if (mpi_rank() == 0) {
+        double ground_truth[] = {158.0, 182.0, 204.0, 241.0, 558.0, 682.0,
+                                 958.0, 1182.0, 250.0, 300.0, 296.0, 359.0,
+                                 604.0, 741.0, 1004.0, 1241.0, 342.0, 418.0,
+                                 388.0, 477.0, 650.0, 800.0, 1050.0, 1300.0};
+        for (size_t i = 0; i < ans.size(); i++) {
+            EXPECT_DOUBLE_EQ(ans[i], ground_truth[i]);
+        }
+    }
+}
+TEST_F(FunctionDistributedTest, TTMC) {
+    // Initialization
+    auto *dis_global = new DistributionGlobal();
+    std::vector<Tensor<double>> m;
+    shape_t rows = {2, 2, 3};
+    for (size_t n = 0; n < t.ndim(); n++) {
+        Tensor<double> m_n(dis_global, {rows[n], t.shape_global()[n]});
+        for (size_t i = 0; i < m_n.size(); i++) {
+            m_n[i] = (double) (i % 7) - 3.0;
+        }
+        m.push_back(m_n);
+    }
+    // Calculate, modes 0 and 1 share one reduce-scatter.
+    auto chain = t;
+    for (size_t n = 0; n < t.ndim(); n++) {
+        chain = Function::ttm<double>(chain, m[n], n);
+    }
+    auto all = Function::ttmc<double>(t, {m[2], m[0], m[1]}, {2, 0, 1});
+    auto skip = Function::ttmc<double>(t, m, 1);
+    auto skip_chain = Function::ttm<double>(Function::ttm<double>(t, m[2], 2),
+                                            m[0], 0);
+    // Gather
+    auto ans = Function::gather(all);
+    auto ans_chain = Function::gather(chain);
+    auto ans_skip = Function::gather(skip);
+    auto ans_skip_chain = Function::gather(skip_chain);
+    // Ground Truth
+    if (mpi_rank() == 0) {
+        ASSERT_EQ(ans.shape(), ans_chain.shape());
+        for (size_t i = 0; i < ans.size(); i++) {
+            EXPECT_DOUBLE_EQ(ans[i], ans_chain[i]);
+        }
+        ASSERT_EQ(ans_skip.shape(), ans_skip_chain.shape());
+        for (size_t i = 0; i < ans_skip.size(); i++) {
+            EXPECT_DOUBLE_EQ(ans_skip[i], ans_skip_chain[i]);
+        }
+    }
+}
+TEST_F(FunctionDistributedTest, TTMPipelined) {
+    // Initialization, the last mode is also split to chunk its rows.
+    auto *dis_global = new DistributionGlobal();
+    auto *dis_last = new DistributionCartesianBlock({1, 2, 3}, mpi_rank());
+    Tensor<double> t_last(dis_last, {5, 4, 3});
+    for (size_t i = 0; i < t_last.size(); i++) {
+        t_last[i] = 10.0 * mpi_rank() + 1.0 * (double) i;
+    }
+    std::vector<Tensor<double>> m;
+    shape_t rows = {4, 3, 5};
+    for (size_t n = 0; n < t.ndim(); n++) {
+        Tensor<double> m_n(dis_global, {rows[n], t.shape_global()[n]});
+        for (size_t i = 0; i < m_n.size(); i++) {
+            m_n[i] = (double) (i % 5) - 2.0;
+        }
+        m.push_back(m_n);
+    }
+    for (auto *tensor: {&t, &t_last}) {
+        for (size_t n = 0; n < t.ndim(); n++) {
+            // Calculate, one chunk per slab or row against no pipeline.
+            Function::set_ttm_chunk_size(1);
+            auto pipelined = Function::ttm<double>(*tensor, m[n], n);
+            Function::set_ttm_chunk_size(0);
+            auto blocking = Function::ttm<double>(*tensor, m[n], n);
+            Function::set_ttm_chunk_size(Constant::kTTMChunkSize);
+            // Gather
+            auto ans = Function::gather(pipelined);
+            auto ans_blocking = Function::gather(blocking);
+            if (mpi_rank() == 0) {
+                for (size_t i = 0; i < ans.size(); i++) {
+                    EXPECT_DOUBLE_EQ(ans[i], ans_blocking[i]);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,88 @@
+//
+// Tucker algorithms on a tensor of known low multilinear rank.
+//
+
+#include "FunctionDistributedTest.hpp"
+#include "algorithm.hpp"
+
+namespace {
+    /**
+     * Tensor of shape I and multilinear rank R, plus deterministic noise of
+     * amplitude noise, distributed along mode 1.
+     */
+    Tensor<double> low_rank_(const shape_t &I, const shape_t &R,
+                             double noise) {
+        Tensor<double> A(I, false);
+        for (size_t k = 0; k < I[2]; k++) {
+            for (size_t j = 0; j < I[1]; j++) {
+                for (size_t i = 0; i < I[0]; i++) {
+                    double value = 0;
+                    for (size_t c = 0; c < R[2]; c++) {
+                        for (size_t b = 0; b < R[1]; b++) {
+                            for (size_t a = 0; a < R[0]; a++) {
+                                value += (double) (1 + a + 2 * b + 3 * c) *
+                                         std::sin(0.7 * (double) ((i + 1) * (a + 1))) *
+                                         std::cos(0.3 * (double) ((j + 2) * (b + 1))) *
+                                         std::sin(0.5 * (double) ((k + 3) * (c + 1)));
+                            }
+                        }
+                    }
+                    const size_t kIndex = i + I[0] * (j + I[1] * k);
+                    A[kIndex] = value + noise * std::sin(13.1 * (double) kIndex);
+                }
+            }
+        }
+        auto *distribution = new DistributionCartesianBlock(
+                {1, (size_t) mpi_size(), 1}, mpi_rank());
+        return Function::scatter(A, distribution, 0);
+    }
+} // namespace
+
+TEST_F(FunctionDistributedTest, RandomizedSTHOSVD) {
+    // Initialization
+    const shape_t kR{3, 3, 2};
+    auto A = low_rank_({12, 10, 8}, kR, 1e-2);
+    // Calculate
+    auto truth = Algorithm::Tucker::STHOSVD(A, kR);
+    auto ans = Algorithm::Tucker::Randomized_STHOSVD(A, kR);
+    // The noise is all that is left, and the sketch finds nearly the same
+    // subspaces as the SVD.
+    const double kResidual = truth.iterations.back().residual;
+    EXPECT_GT(kResidual, 0);
+    EXPECT_LT(kResidual, 1e-2);
+    EXPECT_LE(ans.iterations.back().residual, 1.1 * kResidual);
+}
+
+TEST_F(FunctionDistributedTest, HOOIALSSchedule) {
+    // Initialization
+    const shape_t kR{3, 3, 2};
+    auto A = low_rank_({12, 10, 8}, kR, 1e-1);
+    // Calculate, from the same STHOSVD initialization
+    auto truth = Algorithm::Tucker::HOOI_ALS(
+            A, kR, 3, 0, Algorithm::Tucker::Initializer::kSTHOSVD,
+            Algorithm::Tucker::TTMcSchedule::kFlat);
+    auto ans = Algorithm::Tucker::HOOI_ALS(
+            A, kR, 3, 0, Algorithm::Tucker::Initializer::kSTHOSVD,
+            Algorithm::Tucker::TTMcSchedule::kTree);
+    // The schedules only reorder the TTMs.
+    ASSERT_EQ(ans.iterations.size(), truth.iterations.size());
+    for (size_t t = 0; t < truth.iterations.size(); t++) {
+        const double kCoreNorm = truth.iterations[t].core_norm;
+        EXPECT_NEAR(ans.iterations[t].core_norm, kCoreNorm, 1e-10 * kCoreNorm);
+    }
+    // Same subspaces, up to a rotation: ||U_tree^T U_flat||_F^2 = R[n].
+    for (size_t n = 0; n < kR.size(); n++) {
+        const size_t kI = truth.U[n].shape()[0];
+        double sqnorm = 0;
+        for (size_t b = 0; b < kR[n]; b++) {
+            for (size_t a = 0; a < kR[n]; a++) {
+                double dot = 0;
+                for (size_t i = 0; i < kI; i++) {
+                    dot += ans.U[n][i + kI * a] * truth.U[n][i + kI * b];
+                }
+                sqnorm += dot * dot;
+            }
+        }
+        EXPECT_NEAR(sqnorm, (double) kR[n], 1e-8);
+    }
+}